@@ -33,7 +33,9 @@ extern "C" {
 	#define TE_NONNULL
 	#define TE_NULLABLE
 	#if !defined(TE_EXPORT)
-		#if defined (TE_BUILD_DLL)
+		#if !defined(_WIN32)
+			#define TE_EXPORT __attribute__((visibility("default")))
+		#elif defined (TE_BUILD_DLL)
 			#define TE_EXPORT __declspec(dllexport)
 		#else
 			#define TE_EXPORT __declspec(dllimport)
@@ -42,7 +44,13 @@ extern "C" {
 #endif
 
 // This form is supported for C by MSVC and LLVM, please contact us if your compiler doesn't support it
-#define TE_ENUM(_name, _type) enum _name : _type _name; enum _name : _type
+#if defined(__cplusplus) && defined(__GNUC__) && !defined(__clang__)
+	// GCC rejects the opaque declaration inside a typedef, C++ names the enum without it, so the
+	// typedef gets a throwaway name instead
+	#define TE_ENUM(_name, _type) _type _name##_Base; enum _name : _type
+#else
+	#define TE_ENUM(_name, _type) enum _name : _type _name; enum _name : _type
+#endif
 
 #ifdef __cplusplus
 }
@@ -80,13 +80,13 @@ template <typename T, typename U>
 struct TouchIsMemberOf<T, U, typename std::enable_if_t<
 	std::is_same<T, TEObject>::value ||
 	(std::is_same<T, TETexture>::value && (
-		std::is_same<U, TEOpenGLTexture>::value ||
+		std::is_same<U, TEOpenGLTexture>::value
 #ifdef _WIN32
-		std::is_same<U, TED3DSharedTexture>::value ||
+		|| std::is_same<U, TED3DSharedTexture>::value ||
 		std::is_same<U, TED3D11Texture>::value ||
 		std::is_same<U, TEVulkanTexture>::value
-#else
-		std::is_same<U, TEIOSurfaceTexture>::value
+#elif defined(__APPLE__)
+		|| std::is_same<U, TEIOSurfaceTexture>::value
 #endif
 		)
 	) ||
@@ -7,6 +7,9 @@
 #include "ffgl/FFGLPluginSDK.cpp"
 #include "ffgl/FFGLThumbnailInfo.cpp"
 #include "ffgl/FFGLLog.cpp"
+#if defined( FFGL_TRACE )
+#include "ffgl/FFGLTrace.cpp"
+#endif
 
 #include "ffglex/FFGLFBO.cpp"
 #include "ffglex/FFGLScopedBufferBinding.cpp"
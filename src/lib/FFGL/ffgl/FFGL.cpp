@@ -80,6 +80,9 @@
 #include "FFGLPluginSDK.h"
 #include "FFGLThumbnailInfo.h"
 #include "FFGLLog.h"
+#if defined( FFGL_TRACE )
+#include "FFGLTrace.h"
+#endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Static and extern variables used in the FreeFrame SDK
@@ -624,11 +627,7 @@ FFUInt32 getDefaultParameterVisibility( unsigned int index )
 // Implementation of plugMain, the one and only exposed function
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-#if defined( FFGL_WINDOWS )
-extern "C" __declspec( dllexport ) FFMixed __stdcall plugMain( FFUInt32 functionCode, FFMixed inputValue, FFInstanceID instanceID )
-#elif defined( FFGL_MACOS ) || defined( FFGL_LINUX )
-FFMixed plugMain( FFUInt32 functionCode, FFMixed inputValue, FFInstanceID instanceID )
-#endif
+static FFMixed dispatchCall( FFUInt32 functionCode, FFMixed inputValue, FFInstanceID instanceID )
 {
 	FFMixed retval;
 	retval.UIntValue = FF_FAIL;
@@ -966,6 +965,134 @@ FFMixed plugMain( FFUInt32 functionCode, FFMixed inputValue, FFInstanceID instan
 	return retval;
 }
 
+#if defined( FFGL_TRACE )
+static void traceCall( FFUInt32 functionCode, FFMixed inputValue, FFInstanceID instanceID, FFMixed retval, int64_t start, int64_t end )
+{
+	FFGLTrace::Record record = {};
+	record.time              = start;
+	record.duration          = end - start;
+	record.instance          = (uint64_t)(uintptr_t)instanceID;
+	record.functionCode      = functionCode;
+	record.result            = retval.UIntValue;
+
+	const char* text = nullptr;
+	std::string hostInfo;
+
+	switch( functionCode )
+	{
+	case FF_SET_PARAMETER:
+	{
+		const SetParameterStruct& setParameterStruct = *reinterpret_cast< const SetParameterStruct* >( inputValue.PointerValue );
+		unsigned int paramType                       = getParameterType( setParameterStruct.ParameterNumber );
+		record.index                                 = setParameterStruct.ParameterNumber;
+		if( paramType == FF_TYPE_TEXT || paramType == FF_TYPE_FILE )
+			text = (const char*)setParameterStruct.NewParameterValue.PointerValue;
+		else
+			record.value = setParameterStruct.NewParameterValue.UIntValue;
+		break;
+	}
+	case FF_SET_PARAMETER_ELEMENT_VALUE:
+	{
+		const SetParameterElementValueStruct* arguments = (const SetParameterElementValueStruct*)inputValue.PointerValue;
+		record.index                                    = arguments->ParameterNumber;
+		record.number                                   = arguments->ElementNumber;
+		record.value                                    = arguments->NewParameterValue.UIntValue;
+		break;
+	}
+	case FF_PROCESS_OPENGL:
+	{
+		const ProcessOpenGLStruct* pogls = (const ProcessOpenGLStruct*)inputValue.PointerValue;
+		if( pogls == nullptr )
+			break;
+		record.numInputs = pogls->numInputTextures;
+		for( FFUInt32 i = 0; i < pogls->numInputTextures && i < FFGLTrace::MaxInputs; ++i )
+		{
+			if( pogls->inputTextures[ i ] == nullptr )
+				continue;
+			record.width[ i ]  = pogls->inputTextures[ i ]->Width;
+			record.height[ i ] = pogls->inputTextures[ i ]->Height;
+		}
+		break;
+	}
+	case FF_INSTANTIATE_GL:
+	case FF_RESIZE:
+	{
+		const FFGLViewportStruct* viewport = (const FFGLViewportStruct*)inputValue.PointerValue;
+		if( viewport != nullptr )
+		{
+			record.width[ 0 ]  = viewport->width;
+			record.height[ 0 ] = viewport->height;
+		}
+		//The host refers to the new instance by the pointer we returned
+		if( functionCode == FF_INSTANTIATE_GL )
+			record.instance = (uint64_t)(uintptr_t)retval.PointerValue;
+		break;
+	}
+	case FF_SET_TIME:
+		if( inputValue.PointerValue != nullptr )
+			record.number = *(const double*)inputValue.PointerValue;
+		break;
+	case FF_SET_BEATINFO:
+	{
+		const SetBeatinfoStruct* beatInfo = reinterpret_cast< const SetBeatinfoStruct* >( inputValue.PointerValue );
+		record.number                     = beatInfo->bpm;
+		record.number2                    = beatInfo->barPhase;
+		break;
+	}
+	case FF_SET_HOSTINFO:
+	{
+		const SetHostinfoStructTag* info = reinterpret_cast< const SetHostinfoStructTag* >( inputValue.PointerValue );
+		hostInfo                         = std::string( info->name != nullptr ? info->name : "" ) + '\0' + ( info->version != nullptr ? info->version : "" );
+		text                             = hostInfo.data();
+		record.textLength                = (uint32_t)hostInfo.size();
+		break;
+	}
+	case FF_GET_PARAMETER_NAME:
+	case FF_GET_PARAMETER_DEFAULT:
+	case FF_GET_PARAMETER_DISPLAY:
+	case FF_GET_PARAMETER:
+	case FF_GET_PLUGIN_CAPS:
+	case FF_ENABLE_PLUGIN_CAP:
+	case FF_GET_PARAMETER_TYPE:
+	case FF_GET_INPUT_STATUS:
+	case FF_GET_NUM_PARAMETER_ELEMENTS:
+	case FF_GET_NUM_ELEMENT_SEPARATORS:
+	case FF_GET_PARAMETER_USAGE:
+	case FF_SET_SAMPLERATE:
+	case FF_GET_NUM_FILE_PARAMETER_EXTENSIONS:
+	case FF_GET_PRAMETER_VISIBILITY:
+		record.index = inputValue.UIntValue;
+		break;
+	default:
+		break;
+	}
+
+	if( text != nullptr && record.textLength == 0 )
+		record.textLength = (uint32_t)strlen( text );
+
+	FFGLTrace::Writer::Get().Write( record, text );
+}
+#endif
+
+#if defined( FFGL_WINDOWS )
+extern "C" __declspec( dllexport ) FFMixed __stdcall plugMain( FFUInt32 functionCode, FFMixed inputValue, FFInstanceID instanceID )
+#elif defined( FFGL_MACOS ) || defined( FFGL_LINUX )
+FFMixed plugMain( FFUInt32 functionCode, FFMixed inputValue, FFInstanceID instanceID )
+#endif
+{
+#if defined( FFGL_TRACE )
+	FFGLTrace::Writer& writer = FFGLTrace::Writer::Get();
+	if( writer.IsOpen() )
+	{
+		int64_t start  = writer.Now();
+		FFMixed retval = dispatchCall( functionCode, inputValue, instanceID );
+		traceCall( functionCode, inputValue, instanceID, retval, start, writer.Now() );
+		return retval;
+	}
+#endif
+	return dispatchCall( functionCode, inputValue, instanceID );
+}
+
 #if defined( FFGL_WINDOWS )
 extern "C" __declspec( dllexport ) void __stdcall SetLogCallback( PFNLog logCallback )
 #elif defined( FFGL_MACOS ) || defined( FFGL_LINUX )
@@ -309,7 +309,12 @@ typedef unsigned __int64 FFUInt64;
 #if defined( FFGL_MACOS )
 #include <OpenGL/gl3.h>
 #elif defined( FFGL_LINUX )
-#include <GL/glew.h>
+//libGL exports every core entry point on Linux, so no extension loader is needed
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
 #else
 #error define this for your OS
 #endif
@@ -171,7 +171,7 @@ public:
 	///						It should be in the range [0, parameter.Number of elements).
 	///	\return				FFGL result indicating if setting the value succeeded. Setting a value might fail
 	///						if either of the provided indices is out of range. FF_SUCCESS on success, FF_FAIL otherwise.
-	FFUInt32 SetParamElementValue( unsigned int dwIndex, unsigned int elIndex, float newValue );
+	virtual FFUInt32 SetParamElementValue( unsigned int dwIndex, unsigned int elIndex, float newValue );
 	/// Get the number of element separators a parameter may have. Calling this only makes sense for FF_TYPE_OPTION parameters
 	/// as those are the only parameters which can contain separatable elements.
 	///
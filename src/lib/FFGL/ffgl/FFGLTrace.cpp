@@ -0,0 +1,100 @@
+#include "FFGLTrace.h"
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+namespace FFGLTrace
+{
+//Calls are buffered and flushed in batches so tracing doesn't add a write per host call.
+static const uint32_t FlushInterval = 4096;
+
+static int64_t GetTimeNs()
+{
+	return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+Writer& Writer::Get()
+{
+	static Writer writer;
+	return writer;
+}
+
+Writer::Writer()
+{
+	const char* path = getenv( "FFGL_TRACE_FILE" );
+	if( path == nullptr || path[ 0 ] == '\0' )
+		return;
+
+	file = fopen( path, "wb" );
+	if( file == nullptr )
+		return;
+
+	fwrite( Magic, sizeof( Magic ), 1, file );
+	fwrite( &Version, sizeof( Version ), 1, file );
+	start = GetTimeNs();
+}
+
+Writer::~Writer()
+{
+	if( file != nullptr )
+		fclose( file );
+}
+
+int64_t Writer::Now() const
+{
+	return GetTimeNs() - start;
+}
+
+void Writer::Write( const Record& record, const char* text )
+{
+	std::lock_guard< std::mutex > lock( mutex );
+	if( file == nullptr )
+		return;
+
+	fwrite( &record, sizeof( record ), 1, file );
+	if( record.textLength > 0 )
+		fwrite( text, record.textLength, 1, file );
+
+	if( ++unflushed >= FlushInterval )
+	{
+		fflush( file );
+		unflushed = 0;
+	}
+}
+
+Reader::~Reader()
+{
+	if( file != nullptr )
+		fclose( file );
+}
+
+bool Reader::Open( const std::string& path )
+{
+	file = fopen( path.c_str(), "rb" );
+	if( file == nullptr )
+		return false;
+
+	char magic[ 4 ];
+	uint32_t version = 0;
+	if( fread( magic, sizeof( magic ), 1, file ) != 1 || memcmp( magic, Magic, sizeof( magic ) ) != 0 ||
+		fread( &version, sizeof( version ), 1, file ) != 1 || version != Version )
+	{
+		fclose( file );
+		file = nullptr;
+		return false;
+	}
+	return true;
+}
+
+bool Reader::Next( Record& record, std::string& text )
+{
+	if( file == nullptr || fread( &record, sizeof( record ), 1, file ) != 1 )
+		return false;
+
+	text.resize( record.textLength );
+	if( record.textLength > 0 && fread( &text[ 0 ], record.textLength, 1, file ) != 1 )
+		return false;
+	return true;
+}
+
+}//namespace FFGLTrace
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <mutex>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Binary trace of every call a host makes into plugMain. Only recorded when the SDK is built with FFGL_TRACE and the
+// FFGL_TRACE_FILE environment variable names the file to write. The file starts with the 4 byte magic and a version,
+// followed by one Record per call, each followed by its textLength bytes of text.
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace FFGLTrace
+{
+static const char Magic[ 4 ]     = { 'F', 'F', 'T', 'R' };
+static const uint32_t Version    = 1;
+static const uint32_t MaxInputs  = 2;
+
+struct Record
+{
+	int64_t time;                 //!< Nanoseconds since the trace started, taken when the call started.
+	int64_t duration;             //!< Nanoseconds spent in the call.
+	uint64_t instance;            //!< Instance the call was made on, the created instance for FF_INSTANTIATE_GL.
+	uint32_t functionCode;
+	uint32_t index;               //!< Parameter, capability or input index, or the sample rate.
+	uint32_t value;               //!< Raw FFMixed value, the float bits for parameter values.
+	uint32_t result;
+	double number;                //!< Time for FF_SET_TIME, bpm for FF_SET_BEATINFO, element for FF_SET_PARAMETER_ELEMENT_VALUE.
+	double number2;               //!< Bar phase for FF_SET_BEATINFO.
+	uint32_t numInputs;
+	uint32_t width[ MaxInputs ];  //!< Input texture sizes, or the viewport for FF_INSTANTIATE_GL and FF_RESIZE.
+	uint32_t height[ MaxInputs ];
+	uint32_t textLength;          //!< Text parameter value, or "name\0version" for FF_SET_HOSTINFO.
+};
+
+class Writer
+{
+public:
+	static Writer& Get();
+
+	bool IsOpen() const { return file != nullptr; }
+	int64_t Now() const;
+	void Write( const Record& record, const char* text );
+
+private:
+	Writer();
+	~Writer();
+
+	std::mutex mutex;
+	FILE* file         = nullptr;
+	int64_t start      = 0;
+	uint32_t unflushed = 0;
+};
+
+class Reader
+{
+public:
+	~Reader();
+
+	bool Open( const std::string& path );
+	bool Next( Record& record, std::string& text );
+
+private:
+	FILE* file = nullptr;
+};
+
+}//namespace FFGLTrace
@@ -4,6 +4,12 @@
 
 #include "Thumbnail.h"
 
+#ifdef TOUCHENGINE_MIXER
+constexpr uint32_t MaxVideoInputs = 2;
+#else
+constexpr uint32_t MaxVideoInputs = 1;
+#endif
+
 class FFGLTouchEngineFX : public FFGLTouchEnginePluginBase
 {
 public:
@@ -19,54 +25,13 @@ public:
 	FFResult DeInitGL() override;
 
 private:
-#ifdef _WIN32
-	HANDLE dxInteropHandle = 0;
-
-	HANDLE InputSharedHandle = nullptr;
-	HANDLE dxInteropInputObject = 0;
-
-	HANDLE OutputSharedHandle = nullptr;
-	HANDLE dxInteropOutputObject = 0;
-
-	std::unordered_map<int, IDXGIKeyedMutex*> MutexMap;
-
-	//Spout Configs
-	std::string SpoutIDInput;
-	std::string SpoutIDOutput;
-
-	Spout InputInterop;
-	Spout OutputInterop;
-
-	uint32_t SpoutSenderID = 0;
-	GLuint SpoutTextureOutput = 0;
-	GLuint SpoutTextureInput = 0;
-#endif
-
-#ifdef __APPLE__
-	GLuint OutputTextureGL = 0;
-	id<MTLTexture> OutputMetalTexture = nil;
-	IOSurfaceRef OutputIOSurface = nullptr;
-	IOSurfaceRef InputIOSurface = nullptr;
-	id<MTLTexture> InputMetalTexture = nil;
-	GLuint InputIOSurfaceGL = 0;
-	GLuint InputRenderFBO = 0;
-	ffglex::FFGLShader rectShader;
-#endif
-
-	bool InputInteropInitialized = false;
-	bool OutputInteropInitialized = false;
-
-	std::string InputOpName;
-
-	int InputWidth = 0;
-	int InputHeight = 0;
+	std::vector<std::unique_ptr<TouchEngineInput>> Inputs;
 
 	void ResetBaseParameters() override;
 
-#ifdef _WIN32
-	bool CreateInputTexture(int width, int height, DXGI_FORMAT dxformat);
-	bool CreateOutputTexture(int width, int height, DXGI_FORMAT dxformat);
-#endif
+	FFResult PrepareInput(TouchEngineInput& input, const FFGLTextureStruct& texture);
+	FFResult UploadInputs(ProcessOpenGLStruct* pGL);
+	void ReleaseInputs();
 
 	void ResumeTouchEngine() override;
 	void ClearTouchInstance() override;
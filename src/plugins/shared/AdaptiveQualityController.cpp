@@ -0,0 +1,74 @@
+#include "AdaptiveQualityController.h"
+
+#include <algorithm>
+
+void AdaptiveQualityController::SetBudget(double budgetMs)
+{
+	settings.BudgetMs = std::max(budgetMs, 1.0);
+}
+
+void AdaptiveQualityController::Reset()
+{
+	averageMs = 0.0;
+	hasSample = false;
+	framesSinceChange = 0;
+	renderScale = 1.0f;
+	tickDivisor = 1;
+}
+
+void AdaptiveQualityController::AddSample(double frameMs)
+{
+	if (frameMs <= 0.0) {
+		return;
+	}
+
+	// A tick divisor spreads TouchEngine's cost over several host frames
+	frameMs /= tickDivisor;
+
+	if (!hasSample) {
+		averageMs = frameMs;
+		hasSample = true;
+		return;
+	}
+
+	averageMs += (frameMs - averageMs) * settings.Smoothing;
+}
+
+bool AdaptiveQualityController::Update()
+{
+	framesSinceChange++;
+
+	if (!hasSample) {
+		return false;
+	}
+
+	if (averageMs > settings.BudgetMs && framesSinceChange >= settings.DegradeHoldFrames) {
+		// Resolution is the cheaper loss, drop it before dropping frames
+		if (renderScale > settings.MinScale) {
+			renderScale = std::max(settings.MinScale, renderScale - settings.ScaleStep);
+		} else if (tickDivisor < settings.MaxTickDivisor) {
+			tickDivisor++;
+		} else {
+			return false;
+		}
+		framesSinceChange = 0;
+		hasSample = false;
+		return true;
+	}
+
+	if (averageMs < settings.BudgetMs * settings.LowerBand && framesSinceChange >= settings.RecoverHoldFrames) {
+		// Recover in reverse order, frame rate first
+		if (tickDivisor > 1) {
+			tickDivisor--;
+		} else if (renderScale < 1.0f) {
+			renderScale = std::min(1.0f, renderScale + settings.ScaleStep);
+		} else {
+			return false;
+		}
+		framesSinceChange = 0;
+		hasSample = false;
+		return true;
+	}
+
+	return false;
+}
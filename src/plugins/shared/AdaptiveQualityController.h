@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+// Holds a TouchEngine frame-time budget by trading render scale first and
+// tick rate second. Changes are rate limited and use a hysteresis band so a
+// show on a shared GPU settles instead of oscillating.
+class AdaptiveQualityController
+{
+public:
+	struct Settings {
+		double BudgetMs = 16.0;        //!< Target TouchEngine frame cost.
+		double LowerBand = 0.7;        //!< Quality is only raised below BudgetMs * LowerBand.
+		double Smoothing = 0.1;        //!< Weight of a new sample in the moving average.
+		uint32_t DegradeHoldFrames = 15;//!< Minimum host frames between two reductions.
+		uint32_t RecoverHoldFrames = 60;//!< Minimum host frames between two increases.
+		float MinScale = 0.25f;
+		float ScaleStep = 0.125f;
+		uint32_t MaxTickDivisor = 4;
+	};
+
+	void SetBudget(double budgetMs);
+	double GetBudget() const { return settings.BudgetMs; }
+
+	void Reset();
+	// Feeds one measured TouchEngine frame cost in milliseconds.
+	void AddSample(double frameMs);
+	// Called once per host frame, returns true when scale or divisor changed.
+	bool Update();
+
+	float GetRenderScale() const { return renderScale; }
+	uint32_t GetTickDivisor() const { return tickDivisor; }
+	double GetAverageMs() const { return averageMs; }
+
+private:
+	Settings settings;
+	double averageMs = 0.0;
+	bool hasSample = false;
+	uint32_t framesSinceChange = 0;
+	float renderScale = 1.0f;
+	uint32_t tickDivisor = 1;
+};
@@ -0,0 +1,99 @@
+#include "ControlChannel.h"
+
+#include <cstring>
+
+// Records more than this far ahead come from a writer on another clock, apply them now
+static constexpr int64_t MaxLeadNs = 1000000000;
+
+ControlChannel::~ControlChannel()
+{
+	Close();
+}
+
+bool ControlChannel::Open(const std::string& channelName)
+{
+	Close();
+
+	if (!OpenSharedMemory("TEFFGL_" + channelName, sizeof(Layout), region)) {
+		return false;
+	}
+	layout = static_cast<Layout*>(region.Memory);
+
+	// A new region is zero filled, the first process to map it writes the header
+	if (layout->Magic.load(std::memory_order_acquire) == 0) {
+		layout->Version = Version;
+		layout->Capacity = Capacity;
+		layout->RecordSize = sizeof(Record);
+		layout->Magic.store(Magic, std::memory_order_release);
+	}
+
+	if (layout->Magic.load(std::memory_order_acquire) != Magic || layout->Version != Version ||
+		layout->Capacity != Capacity || layout->RecordSize != sizeof(Record)) {
+		Close();
+		return false;
+	}
+
+	name = channelName;
+	readIndex = layout->WriteIndex.load(std::memory_order_acquire);
+	dropped = 0;
+	return true;
+}
+
+void ControlChannel::Close()
+{
+	// The region outlives the channel, writers stay attached across tox reloads
+	CloseSharedMemory(region);
+	layout = nullptr;
+	name.clear();
+}
+
+uint32_t ControlChannel::Drain(int64_t nowNs, const std::function<void(const char* identifier, double value, int64_t timeNs)>& handler)
+{
+	if (layout == nullptr) {
+		return 0;
+	}
+
+	uint64_t writeIndex = layout->WriteIndex.load(std::memory_order_acquire);
+	if (writeIndex - readIndex > Capacity) {
+		dropped += writeIndex - Capacity - readIndex;
+		readIndex = writeIndex - Capacity;
+	}
+
+	uint32_t count = 0;
+	char identifier[MaxIdentifierLength + 1];
+
+	while (readIndex != writeIndex) {
+		Record& record = layout->Records[readIndex % Capacity];
+		const uint64_t published = readIndex * 2 + 2;
+
+		uint64_t sequence = record.Sequence.load(std::memory_order_acquire);
+		if (sequence < published) {
+			// Claimed but not written yet, picked up on a later drain
+			break;
+		}
+
+		if (sequence == published) {
+			double value = record.Value;
+			int64_t timeNs = record.TimeNs;
+			std::memcpy(identifier, record.Identifier, sizeof(identifier));
+			identifier[MaxIdentifierLength] = '\0';
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (record.Sequence.load(std::memory_order_relaxed) == published) {
+				if (timeNs > nowNs && timeNs - nowNs < MaxLeadNs) {
+					break;
+				}
+				handler(identifier, value, timeNs > 0 && timeNs <= nowNs ? timeNs : nowNs);
+				count++;
+				readIndex++;
+				continue;
+			}
+		}
+
+		// Overwritten by a writer that lapped us
+		dropped++;
+		readIndex++;
+	}
+
+	return count;
+}
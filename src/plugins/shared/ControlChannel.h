@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "PlatformSystem.h"
+
+// Named shared-memory ring of parameter changes written by other local processes, such
+// as a tracking system or show control, so they reach TouchEngine without going through
+// the host's own mapping. Writers never wait on the plugin: a writer that laps the
+// reader overwrites the oldest records, and those are skipped.
+//
+// Writers claim a record with WriteIndex.fetch_add(1), set its Sequence to 2 * index + 1,
+// fill it in, then set Sequence to 2 * index + 2 to publish it.
+class ControlChannel
+{
+public:
+	static constexpr uint32_t Magic = 0x43484554;//!< "TEHC"
+	static constexpr uint32_t Version = 1;
+	static constexpr uint32_t Capacity = 1024;
+	static constexpr uint32_t MaxIdentifierLength = 47;
+
+	struct Record {
+		std::atomic<uint64_t> Sequence;
+		double Value;
+		int64_t TimeNs;//!< steady_clock time the value applies at, 0 for as soon as possible.
+		char Identifier[MaxIdentifierLength + 1];//!< TouchEngine parameter identifier, null terminated.
+	};
+
+	struct Layout {
+		std::atomic<uint32_t> Magic;
+		uint32_t Version;
+		uint32_t Capacity;
+		uint32_t RecordSize;
+		std::atomic<uint64_t> WriteIndex;
+		Record Records[ControlChannel::Capacity];
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory records need lock-free 64 bit atomics");
+
+	ControlChannel() = default;
+	~ControlChannel();
+	ControlChannel(const ControlChannel&) = delete;
+	ControlChannel& operator=(const ControlChannel&) = delete;
+
+	// Creates or attaches to the region named 'name', records written before this are ignored.
+	bool Open(const std::string& name);
+	void Close();
+	bool IsOpen() const { return layout != nullptr; }
+	const std::string& GetName() const { return name; }
+
+	// Calls 'handler' for each record published since the last drain, oldest first, and
+	// stops at the first record that is still being written or applies after 'nowNs'.
+	// Returns the number of records handled.
+	uint32_t Drain(int64_t nowNs, const std::function<void(const char* identifier, double value, int64_t timeNs)>& handler);
+	// Number of records overwritten by writers before they could be read.
+	uint64_t GetDroppedCount() const { return dropped; }
+
+private:
+	std::string name;
+	Layout* layout = nullptr;
+	uint64_t readIndex = 0;
+	uint64_t dropped = 0;
+
+	SharedMemory region;
+};
@@ -0,0 +1,78 @@
+#include "OutputRegistry.h"
+
+#include "FFGL/FFGLSDK.h"
+
+OutputRegistry& OutputRegistry::Get()
+{
+	static OutputRegistry registry;
+	return registry;
+}
+
+void OutputRegistry::Publish(const std::string& key, const std::shared_ptr<TouchEngineOutput>& output)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = outputs.find(key);
+	if (it != outputs.end() && !it->second.expired() && it->second.lock() != output) {
+		FFGLLog::LogToHost(("TouchEngine output " + key + " is published twice, set a unique Instance Name").c_str());
+	}
+
+	outputs[key] = output;
+}
+
+void OutputRegistry::Withdraw(const std::string& key, const TouchEngineOutput* output)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = outputs.find(key);
+	if (it == outputs.end()) {
+		return;
+	}
+
+	std::shared_ptr<TouchEngineOutput> current = it->second.lock();
+	if (current == nullptr || current.get() == output) {
+		outputs.erase(it);
+	}
+}
+
+std::shared_ptr<TouchEngineOutput> OutputRegistry::Find(const std::string& key) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto it = outputs.find(key);
+	if (it == outputs.end()) {
+		return nullptr;
+	}
+	return it->second.lock();
+}
+
+std::vector<std::string> OutputRegistry::GetKeys() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::vector<std::string> keys;
+	for (auto& entry : outputs) {
+		if (!entry.second.expired()) {
+			keys.push_back(entry.first);
+		}
+	}
+	return keys;
+}
+
+std::string OutputRegistry::ClaimName(const std::string& stem)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	std::string name = stem;
+	for (uint32_t index = 2; claimedNames.count(name) != 0; index++) {
+		name = stem + "-" + std::to_string(index);
+	}
+	claimedNames.insert(name);
+	return name;
+}
+
+void OutputRegistry::ReleaseName(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	claimedNames.erase(name);
+}
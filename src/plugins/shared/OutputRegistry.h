@@ -0,0 +1,37 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+struct TouchEngineOutput;
+
+// Process-wide list of TouchEngine texture outputs, keyed "instance/output". Plugin
+// instances in one host share its GL context, so any instance can present an output
+// rendered by another one instead of running a second TouchEngine process.
+class OutputRegistry
+{
+public:
+	static OutputRegistry& Get();
+
+	void Publish(const std::string& key, const std::shared_ptr<TouchEngineOutput>& output);
+	// Only removes 'key' while it still refers to 'output', a newer publisher keeps it.
+	void Withdraw(const std::string& key, const TouchEngineOutput* output);
+	std::shared_ptr<TouchEngineOutput> Find(const std::string& key) const;
+	std::vector<std::string> GetKeys() const;
+
+	// Returns 'stem', or 'stem-2', 'stem-3'... while another instance holds it. Instances without
+	// an Instance Name publish under it, so the same tox on several layers gets distinct keys.
+	std::string ClaimName(const std::string& stem);
+	void ReleaseName(const std::string& name);
+
+private:
+	OutputRegistry() = default;
+
+	mutable std::mutex mutex;
+	std::map<std::string, std::weak_ptr<TouchEngineOutput>> outputs;
+	std::set<std::string> claimedNames;
+};
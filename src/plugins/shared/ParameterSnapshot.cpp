@@ -0,0 +1,255 @@
+#include "ParameterSnapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "FFGL/FFGLSDK.h"
+
+static const char SnapshotBankMagic[4] = { 'T', 'E', 'S', 'B' };
+
+template<typename T>
+static void Append(std::vector<uint8_t>& data, T value)
+{
+	size_t offset = data.size();
+	data.resize(offset + sizeof(T));
+	memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+static bool Extract(const std::vector<uint8_t>& data, size_t& offset, T& value)
+{
+	if (offset + sizeof(T) > data.size()) {
+		return false;
+	}
+	memcpy(&value, data.data() + offset, sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
+
+void ParameterSnapshot::WriteHeader(const std::string& identifier, ValueType type)
+{
+	Append<uint16_t>(data, static_cast<uint16_t>(identifier.size()));
+	data.insert(data.end(), identifier.begin(), identifier.end());
+	Append<uint8_t>(data, type);
+}
+
+void ParameterSnapshot::WriteNumber(const std::string& identifier, ValueType type, double number)
+{
+	WriteHeader(identifier, type);
+
+	// Ints and bools don't need the full double
+	switch (type) {
+	case ValueInt:
+		Append<int32_t>(data, static_cast<int32_t>(number));
+		break;
+	case ValueBool:
+		Append<uint8_t>(data, number != 0.0 ? 1 : 0);
+		break;
+	default:
+		Append<double>(data, number);
+		break;
+	}
+}
+
+void ParameterSnapshot::WriteText(const std::string& identifier, const std::string& text)
+{
+	WriteHeader(identifier, ValueText);
+	Append<uint32_t>(data, static_cast<uint32_t>(text.size()));
+	data.insert(data.end(), text.begin(), text.end());
+}
+
+void ParameterSnapshot::Read(const std::function<void(const std::string& identifier, const Value& value)>& visitor) const
+{
+	size_t offset = 0;
+	std::string identifier;
+	Value value;
+
+	while (offset < data.size()) {
+		uint16_t length = 0;
+		uint8_t type = 0;
+		if (!Extract(data, offset, length) || offset + length > data.size()) {
+			return;
+		}
+		identifier.assign(reinterpret_cast<const char*>(data.data() + offset), length);
+		offset += length;
+
+		if (!Extract(data, offset, type)) {
+			return;
+		}
+		value.Type = static_cast<ValueType>(type);
+
+		switch (value.Type) {
+		case ValueFloat:
+			if (!Extract(data, offset, value.Number)) {
+				return;
+			}
+			break;
+		case ValueInt: {
+			int32_t number = 0;
+			if (!Extract(data, offset, number)) {
+				return;
+			}
+			value.Number = number;
+			break;
+		}
+		case ValueBool: {
+			uint8_t flag = 0;
+			if (!Extract(data, offset, flag)) {
+				return;
+			}
+			value.Number = flag;
+			break;
+		}
+		case ValueText: {
+			uint32_t size = 0;
+			if (!Extract(data, offset, size) || offset + size > data.size()) {
+				return;
+			}
+			value.Text.assign(reinterpret_cast<const char*>(data.data() + offset), size);
+			offset += size;
+			break;
+		}
+		default:
+			return;
+		}
+
+		visitor(identifier, value);
+	}
+}
+
+bool SaveSnapshotBank(const std::string& path, const std::vector<ParameterSnapshot>& bank)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::vector<uint8_t> header;
+	Append<uint32_t>(header, static_cast<uint32_t>(bank.size()));
+	file.write(SnapshotBankMagic, sizeof(SnapshotBankMagic));
+	file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+	for (auto& snapshot : bank) {
+		std::vector<uint8_t> size;
+		Append<uint32_t>(size, static_cast<uint32_t>(snapshot.GetData().size()));
+		file.write(reinterpret_cast<const char*>(size.data()), size.size());
+		file.write(reinterpret_cast<const char*>(snapshot.GetData().data()), snapshot.GetData().size());
+	}
+
+	return file.good();
+}
+
+bool LoadSnapshotBank(const std::string& path, std::vector<ParameterSnapshot>& bank)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (data.size() < sizeof(SnapshotBankMagic) || memcmp(data.data(), SnapshotBankMagic, sizeof(SnapshotBankMagic)) != 0) {
+		return false;
+	}
+
+	size_t offset = sizeof(SnapshotBankMagic);
+	uint32_t count = 0;
+	if (!Extract(data, offset, count)) {
+		return false;
+	}
+
+	// Slots beyond the bank size are dropped, missing ones stay empty
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t size = 0;
+		if (!Extract(data, offset, size) || offset + size > data.size()) {
+			return false;
+		}
+		if (i < bank.size()) {
+			bank[i].SetData(std::vector<uint8_t>(data.begin() + offset, data.begin() + offset + size));
+		}
+		offset += size;
+	}
+
+	return true;
+}
+
+std::shared_ptr<SnapshotBankWriter> SnapshotBankWriter::Acquire()
+{
+	static std::mutex acquireMutex;
+	static std::weak_ptr<SnapshotBankWriter> shared;
+
+	std::lock_guard<std::mutex> lock(acquireMutex);
+	std::shared_ptr<SnapshotBankWriter> writer = shared.lock();
+	if (writer == nullptr) {
+		writer.reset(new SnapshotBankWriter());
+		shared = writer;
+	}
+	return writer;
+}
+
+SnapshotBankWriter::~SnapshotBankWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+void SnapshotBankWriter::Queue(const std::string& path, std::vector<ParameterSnapshot> bank)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending[path] = std::move(bank);
+
+		if (!worker.joinable()) {
+			worker = std::thread(&SnapshotBankWriter::Run, this);
+		}
+	}
+	wake.notify_all();
+}
+
+bool SnapshotBankWriter::FindQueued(const std::string& path, std::vector<ParameterSnapshot>& bank)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = pending.find(path);
+	const std::vector<ParameterSnapshot>* queued = it != pending.end() ? &it->second : (path == writingPath ? &writing : nullptr);
+	if (queued == nullptr) {
+		return false;
+	}
+
+	for (size_t i = 0; i < bank.size() && i < queued->size(); i++) {
+		bank[i] = (*queued)[i];
+	}
+	return true;
+}
+
+void SnapshotBankWriter::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		// Pending banks are written even when stopping, the last instance may have just stored one
+		wake.wait(lock, [this] { return stopping || !pending.empty(); });
+		if (pending.empty()) {
+			break;
+		}
+
+		writingPath = pending.begin()->first;
+		writing = std::move(pending.begin()->second);
+		pending.erase(pending.begin());
+
+		lock.unlock();
+		bool saved = SaveSnapshotBank(writingPath, writing);
+		if (!saved) {
+			FFGLLog::LogToHost("Failed to save snapshots");
+		}
+		lock.lock();
+
+		writingPath.clear();
+		writing.clear();
+	}
+}
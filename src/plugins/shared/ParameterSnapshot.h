@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The values of a tox's parameters keyed by TouchEngine identifier, packed into one
+// byte buffer so a bank of them stays small and can be written to disk as is.
+class ParameterSnapshot
+{
+public:
+	enum ValueType : uint8_t {
+		ValueFloat = 0,
+		ValueInt,
+		ValueBool,
+		ValueText
+	};
+
+	struct Value {
+		ValueType Type = ValueFloat;
+		double Number = 0.0;//!< Float, int and bool values.
+		std::string Text;
+	};
+
+	void Clear() { data.clear(); }
+	bool IsEmpty() const { return data.empty(); }
+
+	void WriteNumber(const std::string& identifier, ValueType type, double number);
+	void WriteText(const std::string& identifier, const std::string& text);
+	// Calls 'visitor' for every stored value in capture order, stops at the first malformed entry.
+	void Read(const std::function<void(const std::string& identifier, const Value& value)>& visitor) const;
+
+	const std::vector<uint8_t>& GetData() const { return data; }
+	void SetData(std::vector<uint8_t> bytes) { data = std::move(bytes); }
+
+private:
+	void WriteHeader(const std::string& identifier, ValueType type);
+
+	std::vector<uint8_t> data;
+};
+
+// A bank is stored per tox file, one entry per slot including empty ones.
+bool SaveSnapshotBank(const std::string& path, const std::vector<ParameterSnapshot>& bank);
+bool LoadSnapshotBank(const std::string& path, std::vector<ParameterSnapshot>& bank);
+
+// Writes snapshot banks on a background thread so storing a snapshot never waits on the disk
+// during a show. Shared by all plugin instances in the process, the worker starts with the
+// first queued bank and writes everything still queued before it stops with the last instance.
+class SnapshotBankWriter
+{
+public:
+	static std::shared_ptr<SnapshotBankWriter> Acquire();
+	~SnapshotBankWriter();
+
+	// Replaces any bank queued for 'path' that has not been written yet.
+	void Queue(const std::string& path, std::vector<ParameterSnapshot> bank);
+	// Copies the newest bank queued or being written for 'path', so a reload sees it before it reaches the disk.
+	bool FindQueued(const std::string& path, std::vector<ParameterSnapshot>& bank);
+
+private:
+	SnapshotBankWriter() = default;
+
+	void Run();
+
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::map<std::string, std::vector<ParameterSnapshot>> pending;
+	std::string writingPath;
+	std::vector<ParameterSnapshot> writing;//!< Bank being written, outside the lock.
+	bool stopping = false;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+// Operating system services the core relies on. Each OS implements them in its own source under
+// platform/, picked in CMake.
+
+// Per-user roots the plugins' directories are made in: roaming data and the local cache. Empty
+// when the user has no home directory.
+std::filesystem::path GetUserDataRoot();
+std::filesystem::path GetUserCacheRoot();
+
+// Lowers the calling thread below the host's render thread and TouchEngine.
+void SetBackgroundThreadPriority();
+
+// A named memory region other local processes can map.
+struct SharedMemory {
+	void* Memory = nullptr;
+	size_t Size = 0;
+	intptr_t Handle = -1;//!< File mapping on Windows, descriptor elsewhere.
+};
+
+// Creates or attaches to the region named 'name', zero filled when created. An existing region
+// keeps its size and must be at least 'size' bytes.
+bool OpenSharedMemory(const std::string& name, size_t size, SharedMemory& region);
+// Unmaps the region, which stays available to the other processes attached to it.
+void CloseSharedMemory(SharedMemory& region);
@@ -0,0 +1,194 @@
+#include "PresentationShader.h"
+
+static const char presentationVertexShaderCode[] = R"(
+layout( location = 0 ) in vec4 vPosition;
+layout( location = 1 ) in vec2 vUV;
+
+// MaxUV for 2D textures, texture size in pixels for rectangle textures
+uniform vec2 UVScale;
+
+out vec2 uv;
+#ifdef BLEND_PREVIOUS
+out vec2 previousUV;
+#endif
+
+void main()
+{
+	gl_Position = vPosition;
+	vec2 st = vUV;
+#ifdef FLIP_Y
+	st.y = 1.0 - st.y;
+#endif
+	uv = st * UVScale;
+#ifdef BLEND_PREVIOUS
+	previousUV = st;
+#endif
+}
+)";
+
+static const char presentationFragmentShaderCode[] = R"(
+#ifdef RECT_TEXTURE
+uniform sampler2DRect InputTexture;
+#else
+uniform sampler2D InputTexture;
+#endif
+
+in vec2 uv;
+out vec4 fragColor;
+
+#ifdef BLEND_PREVIOUS
+// Captured with the same orientation and channel order as InputTexture
+uniform sampler2D PreviousTexture;
+uniform float BlendFactor;
+in vec2 previousUV;
+#endif
+
+#ifdef BICUBIC
+// 'texel' is a texel centre in pixels
+vec4 FetchTexel( vec2 texel, vec2 texSize )
+{
+#ifdef RECT_TEXTURE
+	return texture( InputTexture, texel );
+#else
+	return texture( InputTexture, texel / texSize );
+#endif
+}
+
+// Catmull-Rom over a 4x4 neighbourhood, sharper than bilinear when upscaling
+vec4 SampleBicubic( vec2 st )
+{
+#ifdef RECT_TEXTURE
+	vec2 texSize = vec2( 1.0 );
+	vec2 pos = st - 0.5;
+#else
+	vec2 texSize = vec2( textureSize( InputTexture, 0 ) );
+	vec2 pos = st * texSize - 0.5;
+#endif
+	vec2 f = fract( pos );
+	vec2 base = floor( pos ) + 0.5;
+
+	vec2 w0 = f * ( -0.5 + f * ( 1.0 - 0.5 * f ) );
+	vec2 w1 = 1.0 + f * f * ( -2.5 + 1.5 * f );
+	vec2 w2 = f * ( 0.5 + f * ( 2.0 - 1.5 * f ) );
+	vec2 w3 = f * f * ( -0.5 + 0.5 * f );
+	float wx[ 4 ] = float[ 4 ]( w0.x, w1.x, w2.x, w3.x );
+	float wy[ 4 ] = float[ 4 ]( w0.y, w1.y, w2.y, w3.y );
+
+	vec4 color = vec4( 0.0 );
+	for( int j = 0; j < 4; ++j )
+	{
+		for( int i = 0; i < 4; ++i )
+		{
+			color += FetchTexel( base + vec2( i - 1, j - 1 ), texSize ) * wx[ i ] * wy[ j ];
+		}
+	}
+	return color;
+}
+#endif
+
+void main()
+{
+#ifdef BICUBIC
+	vec4 color = SampleBicubic( uv );
+#else
+	vec4 color = texture( InputTexture, uv );
+#endif
+#ifdef BLEND_PREVIOUS
+	color = mix( texture( PreviousTexture, previousUV ), color, BlendFactor );
+#endif
+#ifdef SWIZZLE_BGRA
+	color = color.bgra;
+#endif
+#ifdef UNPREMULTIPLY
+	color.rgb = color.a > 0.0 ? color.rgb / color.a : vec3( 0.0 );
+#endif
+#ifdef PREMULTIPLY
+	color.rgb *= color.a;
+#endif
+#ifdef CLAMP_RANGE
+	color = clamp( color, 0.0, 1.0 );
+#endif
+	fragColor = color;
+}
+)";
+
+static std::string BuildVariantSource(uint32_t features, const char* body)
+{
+	std::string source = "#version 410 core\n";
+	if (features & PresentationSwizzleBGRA) source += "#define SWIZZLE_BGRA\n";
+	if (features & PresentationFlipY) source += "#define FLIP_Y\n";
+	if (features & PresentationRectTexture) source += "#define RECT_TEXTURE\n";
+	if (features & PresentationPremultiply) source += "#define PREMULTIPLY\n";
+	if (features & PresentationUnpremultiply) source += "#define UNPREMULTIPLY\n";
+	if (features & PresentationClampRange) source += "#define CLAMP_RANGE\n";
+	if (features & PresentationBicubic) source += "#define BICUBIC\n";
+	if (features & PresentationBlendPrevious) source += "#define BLEND_PREVIOUS\n";
+	source += body;
+	return source;
+}
+
+ffglex::FFGLShader* PresentationShader::GetVariant(uint32_t features)
+{
+	features &= (1 << PresentationFeatureBits) - 1;
+
+	std::unique_ptr<ffglex::FFGLShader>& variant = Variants[features];
+	if (variant != nullptr) {
+		return variant->IsReady() ? variant.get() : nullptr;
+	}
+
+	variant = std::make_unique<ffglex::FFGLShader>();
+	if (!variant->Compile(BuildVariantSource(features, presentationVertexShaderCode), BuildVariantSource(features, presentationFragmentShaderCode))) {
+		FFGLLog::LogToHost(("Failed to compile presentation shader variant " + std::to_string(features)).c_str());
+		return nullptr;
+	}
+
+	return variant.get();
+}
+
+bool PresentationShader::Prepare(uint32_t features)
+{
+	return GetVariant(features) != nullptr;
+}
+
+bool PresentationShader::Draw(ffglex::FFGLScreenQuad& quad, GLuint texture, uint32_t features, float scaleU, float scaleV, GLuint previousTexture, float blendFactor)
+{
+	if (previousTexture == 0) {
+		features &= ~PresentationBlendPrevious;
+	}
+
+	ffglex::FFGLShader* variant = GetVariant(features);
+	if (variant == nullptr || texture == 0) {
+		return false;
+	}
+
+	GLenum target = (features & PresentationRectTexture) ? GL_TEXTURE_RECTANGLE : GL_TEXTURE_2D;
+
+	ffglex::ScopedShaderBinding shaderBinding(variant->GetGLID());
+	ffglex::ScopedSamplerActivation activateSampler(0);
+	ffglex::ScopedTextureBinding textureBinding(target, texture);
+	variant->Set("InputTexture", 0);
+	variant->Set("UVScale", scaleU, scaleV);
+
+	if (features & PresentationBlendPrevious) {
+		ffglex::ScopedSamplerActivation activatePreviousSampler(1);
+		ffglex::ScopedTextureBinding previousBinding(GL_TEXTURE_2D, previousTexture);
+		variant->Set("PreviousTexture", 1);
+		variant->Set("BlendFactor", blendFactor);
+		quad.Draw();
+		return true;
+	}
+
+	quad.Draw();
+
+	return true;
+}
+
+void PresentationShader::Release()
+{
+	for (auto& variant : Variants) {
+		if (variant != nullptr) {
+			variant->FreeGLResources();
+			variant.reset();
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "FFGL/FFGLSDK.h"
+#include <array>
+#include <memory>
+
+// Feature bits for the final presentation pass. Every combination is a
+// specialisation of one GLSL source, selected with preprocessor defines, so
+// reorienting or reswizzling a frame never needs a copy of its own.
+enum PresentationFeature : uint32_t
+{
+	PresentationSwizzleBGRA   = 1 << 0, //!< Source texels are BGRA (IOSurface), swap to RGBA.
+	PresentationFlipY         = 1 << 1, //!< Source origin differs from the host's, flip vertically.
+	PresentationRectTexture   = 1 << 2, //!< Source is a GL_TEXTURE_RECTANGLE sampled in pixels.
+	PresentationPremultiply   = 1 << 3, //!< Multiply colour by alpha.
+	PresentationUnpremultiply = 1 << 4, //!< Divide colour by alpha.
+	PresentationClampRange    = 1 << 5, //!< Clamp float sources to the 0-1 range the host expects.
+	PresentationBicubic       = 1 << 6, //!< Catmull-Rom filtering for upscaling reduced resolution renders.
+	PresentationBlendPrevious = 1 << 7, //!< Mix in the previous frame, for hosts running faster than TouchEngine.
+};
+
+constexpr uint32_t PresentationFeatureBits = 8;
+
+class PresentationShader
+{
+public:
+	PresentationShader() = default;
+	PresentationShader(const PresentationShader&) = delete;
+	PresentationShader& operator=(const PresentationShader&) = delete;
+
+	// Compiles the variant for 'features' ahead of time so the first draw doesn't stall.
+	bool Prepare(uint32_t features);
+	// Draws 'texture' over the full quad. 'scaleU'/'scaleV' is MaxUV for 2D sources or the
+	// texture size in pixels for rectangle sources. With PresentationBlendPrevious, 'previousTexture' is a
+	// full 2D texture mixed in with weight 1 - 'blendFactor'.
+	bool Draw(ffglex::FFGLScreenQuad& quad, GLuint texture, uint32_t features, float scaleU, float scaleV, GLuint previousTexture = 0, float blendFactor = 1.0f);
+	void Release();
+
+private:
+	ffglex::FFGLShader* GetVariant(uint32_t features);
+
+	std::array<std::unique_ptr<ffglex::FFGLShader>, 1 << PresentationFeatureBits> Variants;
+};
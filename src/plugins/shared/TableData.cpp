@@ -0,0 +1,140 @@
+#include "TableData.h"
+
+#include <algorithm>
+#include <cstring>
+
+TableRows ParseTableText(const std::string& text)
+{
+	TableRows rows;
+	if (text.empty()) {
+		return rows;
+	}
+
+	const char delimiter = text.find('\t') != std::string::npos ? '\t' : ',';
+	std::vector<std::string> row;
+	std::string cell;
+	bool quoted = false;
+
+	for (size_t i = 0; i < text.size(); i++) {
+		char c = text[i];
+
+		if (quoted) {
+			if (c == '"' && i + 1 < text.size() && text[i + 1] == '"') {
+				cell += '"';
+				i++;
+			} else if (c == '"') {
+				quoted = false;
+			} else {
+				cell += c;
+			}
+			continue;
+		}
+
+		if (c == '"' && cell.empty() && delimiter == ',') {
+			quoted = true;
+		} else if (c == delimiter) {
+			row.push_back(std::move(cell));
+			cell.clear();
+		} else if (c == '\n' || c == '\r') {
+			if (c == '\r' && i + 1 < text.size() && text[i + 1] == '\n') {
+				i++;
+			}
+			row.push_back(std::move(cell));
+			cell.clear();
+			rows.push_back(std::move(row));
+			row.clear();
+		} else {
+			cell += c;
+		}
+	}
+
+	// A trailing line break does not start another row
+	if (!cell.empty() || !row.empty()) {
+		row.push_back(std::move(cell));
+		rows.push_back(std::move(row));
+	}
+
+	return rows;
+}
+
+bool ApplyTableRows(TETable* table, const TableRows& rows)
+{
+	int32_t rowCount = static_cast<int32_t>(rows.size());
+	int32_t columnCount = 0;
+	for (auto& row : rows) {
+		columnCount = std::max(columnCount, static_cast<int32_t>(row.size()));
+	}
+
+	bool changed = false;
+	if (TETableGetRowCount(table) != rowCount || TETableGetColumnCount(table) != columnCount) {
+		TETableResize(table, rowCount, columnCount);
+		changed = true;
+	}
+
+	for (int32_t r = 0; r < rowCount; r++) {
+		for (int32_t c = 0; c < columnCount; c++) {
+			// Ragged rows are padded with empty cells
+			const char* value = c < static_cast<int32_t>(rows[r].size()) ? rows[r][c].c_str() : "";
+			const char* current = TETableGetStringValue(table, r, c);
+			if (current != nullptr && strcmp(current, value) == 0) {
+				continue;
+			}
+			TETableSetStringValue(table, r, c, value);
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+bool TablesEqual(const TETable* a, const TETable* b)
+{
+	if (a == b) {
+		return true;
+	}
+
+	int32_t rows = a != nullptr ? TETableGetRowCount(a) : 0;
+	int32_t columns = a != nullptr ? TETableGetColumnCount(a) : 0;
+	if (rows != (b != nullptr ? TETableGetRowCount(b) : 0) || columns != (b != nullptr ? TETableGetColumnCount(b) : 0)) {
+		return false;
+	}
+
+	for (int32_t r = 0; r < rows; r++) {
+		for (int32_t c = 0; c < columns; c++) {
+			const char* left = TETableGetStringValue(a, r, c);
+			const char* right = TETableGetStringValue(b, r, c);
+			if (strcmp(left != nullptr ? left : "", right != nullptr ? right : "") != 0) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+std::string FormatTableText(const TETable* table)
+{
+	std::string text;
+	if (table == nullptr) {
+		return text;
+	}
+
+	int32_t rows = TETableGetRowCount(table);
+	int32_t columns = TETableGetColumnCount(table);
+	for (int32_t r = 0; r < rows; r++) {
+		if (r > 0) {
+			text += '\n';
+		}
+		for (int32_t c = 0; c < columns; c++) {
+			if (c > 0) {
+				text += '\t';
+			}
+			const char* value = TETableGetStringValue(table, r, c);
+			if (value != nullptr) {
+				text += value;
+			}
+		}
+	}
+
+	return text;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "TouchEngine/TouchEngine.h"
+
+typedef std::vector<std::vector<std::string>> TableRows;
+
+// Splits CSV or TSV text into rows of cells. Tabs win over commas when both appear,
+// CSV cells may be quoted to hold delimiters, quotes or line breaks.
+TableRows ParseTableText(const std::string& text);
+
+// Writes 'rows' into 'table', only touching cells whose content differs.
+// Returns true when anything changed, so unchanged tables need not be sent again.
+bool ApplyTableRows(TETable* table, const TableRows& rows);
+
+// Cell-by-cell comparison, a null table equals an empty one.
+bool TablesEqual(const TETable* a, const TETable* b);
+
+// Tab separated rows, one per line.
+std::string FormatTableText(const TETable* table);
@@ -0,0 +1,89 @@
+#include "TouchEngineAccounting.h"
+
+#ifdef TE_ACCOUNTING
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "FFGL/FFGLSDK.h"
+
+// Links beyond this are left out of the report, they cost the least
+static constexpr size_t MaxReportedLinks = 10;
+
+TouchEngineAccounting& TouchEngineAccounting::Get() {
+	static TouchEngineAccounting accounting;
+	return accounting;
+}
+
+void TouchEngineAccounting::Add(const char* api, const char* identifier, int64_t ns) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// Heterogeneous lookup, a key is only allocated the first time it's seen
+	auto it = apis.find(api);
+	if (it == apis.end()) {
+		it = apis.emplace(api, Counter()).first;
+	}
+	it->second.Calls++;
+	it->second.Ns += ns;
+
+	if (identifier == nullptr) {
+		return;
+	}
+
+	auto link = links.find(identifier);
+	if (link == links.end()) {
+		link = links.emplace(identifier, Counter()).first;
+	}
+	link->second.Calls++;
+	link->second.Ns += ns;
+}
+
+void TouchEngineAccounting::EndFrame() {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (++frames < ReportInterval) {
+		return;
+	}
+
+	Report();
+	apis.clear();
+	links.clear();
+	frames = 0;
+}
+
+void TouchEngineAccounting::Report() {
+	auto byTime = [](const std::pair<std::string, Counter>& a, const std::pair<std::string, Counter>& b) {
+		return a.second.Ns > b.second.Ns;
+	};
+
+	char line[256];
+	snprintf(line, sizeof(line), "TouchEngine calls per frame, averaged over %llu frames:", static_cast<unsigned long long>(frames));
+	FFGLLog::LogToHost(line);
+
+	uint64_t totalCalls = 0;
+	int64_t totalNs = 0;
+	std::vector<std::pair<std::string, Counter>> sorted(apis.begin(), apis.end());
+	std::sort(sorted.begin(), sorted.end(), byTime);
+	for (auto& api : sorted) {
+		snprintf(line, sizeof(line), "  %s: %.1f calls, %.1f us", api.first.c_str(),
+			static_cast<double>(api.second.Calls) / frames, api.second.Ns / 1000.0 / frames);
+		FFGLLog::LogToHost(line);
+		totalCalls += api.second.Calls;
+		totalNs += api.second.Ns;
+	}
+
+	snprintf(line, sizeof(line), "  Total: %.1f calls, %.1f us", static_cast<double>(totalCalls) / frames, totalNs / 1000.0 / frames);
+	FFGLLog::LogToHost(line);
+
+	sorted.assign(links.begin(), links.end());
+	std::sort(sorted.begin(), sorted.end(), byTime);
+	sorted.resize(std::min(sorted.size(), MaxReportedLinks));
+	for (auto& link : sorted) {
+		snprintf(line, sizeof(line), "  Link %s: %.1f calls, %.1f us", link.first.c_str(),
+			static_cast<double>(link.second.Calls) / frames, link.second.Ns / 1000.0 / frames);
+		FFGLLog::LogToHost(line);
+	}
+}
+
+#endif
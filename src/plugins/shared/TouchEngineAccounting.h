@@ -0,0 +1,84 @@
+#pragma once
+
+// Optional accounting of the calls the plugin makes into the TouchEngine library. Built with
+// TE_ACCOUNTING, the per-frame API calls below are wrapped by macros that count them and time
+// them per API and per link identifier, and a summary per TouchEngine frame is logged to the
+// host every ReportInterval frames. Without TE_ACCOUNTING this header adds nothing.
+//
+// Include it after the TouchEngine headers. The wrapped name is not expanded again inside its
+// own macro, so the wrapper ends up calling the library function.
+
+#ifdef TE_ACCOUNTING
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+class TouchEngineAccounting
+{
+public:
+	static constexpr uint64_t ReportInterval = 600;
+
+	static TouchEngineAccounting& Get();
+
+	void Add(const char* api, const char* identifier, int64_t ns);
+	// Called once per started TouchEngine frame, across all plugin instances.
+	void EndFrame();
+
+	template<typename Call>
+	static auto Measure(const char* api, const char* identifier, Call&& call) -> decltype(call()) {
+		auto start = std::chrono::steady_clock::now();
+		auto result = call();
+		Get().Add(api, identifier, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+		return result;
+	}
+
+private:
+	struct Counter {
+		uint64_t Calls = 0;
+		int64_t Ns = 0;
+	};
+
+	void Report();
+
+	std::mutex mutex;
+	std::map<std::string, Counter, std::less<>> apis;
+	std::map<std::string, Counter, std::less<>> links;//!< All APIs called on a link identifier.
+	uint64_t frames = 0;
+};
+
+#define TE_ACCOUNT(api, identifier, ...) TouchEngineAccounting::Measure(api, identifier, [&]() { return __VA_ARGS__; })
+
+#define TEInstanceLinkGetBooleanValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetBooleanValue", identifier, TEInstanceLinkGetBooleanValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetChildren(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetChildren", identifier, TEInstanceLinkGetChildren(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetChoiceLabels(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetChoiceLabels", identifier, TEInstanceLinkGetChoiceLabels(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetDoubleValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetDoubleValue", identifier, TEInstanceLinkGetDoubleValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetFloatBufferValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetFloatBufferValue", identifier, TEInstanceLinkGetFloatBufferValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetInfo(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetInfo", identifier, TEInstanceLinkGetInfo(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetIntValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetIntValue", identifier, TEInstanceLinkGetIntValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetStringValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetStringValue", identifier, TEInstanceLinkGetStringValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetTableValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetTableValue", identifier, TEInstanceLinkGetTableValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkGetTextureValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkGetTextureValue", identifier, TEInstanceLinkGetTextureValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkHasChoices(instance, identifier) TE_ACCOUNT("TEInstanceLinkHasChoices", identifier, TEInstanceLinkHasChoices(instance, identifier))
+#define TEInstanceLinkAddFloatBuffer(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkAddFloatBuffer", identifier, TEInstanceLinkAddFloatBuffer(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkSetBooleanValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkSetBooleanValue", identifier, TEInstanceLinkSetBooleanValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkSetDoubleValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkSetDoubleValue", identifier, TEInstanceLinkSetDoubleValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkSetFloatBufferValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkSetFloatBufferValue", identifier, TEInstanceLinkSetFloatBufferValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkSetIntValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkSetIntValue", identifier, TEInstanceLinkSetIntValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkSetStringValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkSetStringValue", identifier, TEInstanceLinkSetStringValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkSetTableValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkSetTableValue", identifier, TEInstanceLinkSetTableValue(instance, identifier, __VA_ARGS__))
+#define TEInstanceLinkSetTextureValue(instance, identifier, ...) TE_ACCOUNT("TEInstanceLinkSetTextureValue", identifier, TEInstanceLinkSetTextureValue(instance, identifier, __VA_ARGS__))
+
+#define TEInstanceStartFrameAtTime(instance, ...) TE_ACCOUNT("TEInstanceStartFrameAtTime", nullptr, TEInstanceStartFrameAtTime(instance, __VA_ARGS__))
+#define TEInstanceGetTextureTransfer(instance, ...) TE_ACCOUNT("TEInstanceGetTextureTransfer", nullptr, TEInstanceGetTextureTransfer(instance, __VA_ARGS__))
+#define TEInstanceAddTextureTransfer(instance, ...) TE_ACCOUNT("TEInstanceAddTextureTransfer", nullptr, TEInstanceAddTextureTransfer(instance, __VA_ARGS__))
+
+#define TE_ACCOUNT_END_FRAME() TouchEngineAccounting::Get().EndFrame()
+
+#else
+
+#define TE_ACCOUNT_END_FRAME()
+
+#endif
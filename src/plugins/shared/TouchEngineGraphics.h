@@ -0,0 +1,53 @@
+#pragma once
+
+#include <memory>
+
+#include "FFGL/FFGLSDK.h"
+#include "TouchEngine/TouchEngine.h"
+
+struct TouchEngineOutput;
+struct TouchEngineInput;
+
+// Platform copy state kept with one output or input, subclassed by each graphics backend.
+// Destroying it frees everything it holds, which needs the host GL context.
+struct TextureInterop {
+	virtual ~TextureInterop() = default;
+};
+
+// The graphics API TouchEngine renders with: its device, the TouchEngine graphics context, and
+// the copies between TouchEngine textures and the host's GL textures. The core only sees this
+// interface, each platform implements it in its own source under platform/, D3D11 and Spout on
+// Windows, Metal and IOSurface on macOS, OpenGL against the stub TouchEngine on Linux.
+class TouchEngineGraphics
+{
+public:
+	virtual ~TouchEngineGraphics() = default;
+
+	// Creates the device, called from InitGL.
+	virtual FFResult InitializeDevice() = 0;
+	// Creates a TouchEngine graphics context on the device and associates it with 'instance'.
+	virtual bool AssociateContext(TEInstance* instance) = 0;
+	// Drops the graphics context, the next instance gets a new one.
+	virtual void ReleaseContext() = 0;
+	// Frees the GL objects kept across frames. Needs the host GL context.
+	virtual void ReleaseGL() = 0;
+
+	// PresentationFeature bits every fetched output texture needs.
+	virtual uint32_t GetTextureFeatures() const = 0;
+
+	// Copies the current texture of 'output' into output.Texture, recreating the copy when its size
+	// or format changed. Leaves the last copy in place when TouchEngine has nothing new.
+	virtual FFResult FetchOutput(TEInstance* instance, TouchEngineOutput& output, GLuint hostFBO) = 0;
+
+	// Copies 'texture' into 'input', creating its interop for input.Width, Height and Format when
+	// it has none. Every input of a frame is copied before any of them is sent.
+	virtual FFResult CopyInput(TouchEngineInput& input, const FFGLTextureStruct& texture, GLuint hostFBO) = 0;
+	// Waits for the copies of a frame's inputs, TouchEngine may read them from another device.
+	virtual void FinishInputs() = 0;
+	// Sets the input's link to its last copy, described with the host's 'origin'.
+	virtual TEResult SendInput(TEInstance* instance, const TouchEngineInput& input, TETextureOrigin origin) = 0;
+};
+
+// Creates the backend of the platform source the plugin links. 'logName' names the log file of
+// the interop library on platforms that keep one.
+std::unique_ptr<TouchEngineGraphics> CreateTouchEngineGraphics(const char* logName);
@@ -1,4 +1,10 @@
 #include "TouchEnginePluginBase.h"
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "FFGL/ffglex/FFGLScopedFBOBinding.h"
 
 FFResult FailAndLog(std::string message)
 {
@@ -32,54 +38,13 @@ std::string GenerateRandomString(size_t length) {
 	return str;
 }
 
-#ifdef _WIN32
-DXGI_FORMAT GlToDXFromat(GLint format) {
-
-	switch (format) {
-	case GL_RGBA8:
-		return DXGI_FORMAT_B8G8R8A8_UNORM;
-
-	case GL_RGB8:
-		return DXGI_FORMAT_R8G8B8A8_UNORM;
-
-	case GL_RGBA16:
-		return DXGI_FORMAT_R16G16B16A16_UNORM;
-
-
-
-	default:
-		auto s = "Unsupported Format:: " + std::to_string(format);
-		FFGLLog::LogToHost(s.c_str());
-	}
+static int64_t GetSteadyTimeNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
-#endif
 
-GLenum GetGlType(GLint format) {
-	switch (format) {
-	case GL_UNSIGNED_BYTE:
-		return GL_RGBA;
-	case GL_RGBA16:
-		return GL_UNSIGNED_SHORT;
-	}
-}
-
-#ifdef _WIN32
-GLenum GetGlType(DXGI_FORMAT format) {
-	switch (format) {
-	case DXGI_FORMAT_B8G8R8A8_UNORM:
-		return GL_UNSIGNED_BYTE;
-	case DXGI_FORMAT_R16G16B16A16_UNORM:
-		return GL_UNSIGNED_SHORT;
-	case DXGI_FORMAT_R32G32B32A32_FLOAT:
-		return GL_FLOAT;
-	default:
-		return GL_UNSIGNED_BYTE;
-	}
-}
-#endif
-
-FFGLTouchEnginePluginBase::FFGLTouchEnginePluginBase()
-	: CFFGLPlugin(),
+FFGLTouchEnginePluginBase::FFGLTouchEnginePluginBase(std::unique_ptr<TouchEngineGraphics> graphics)
+	: CFFGLPlugin(true),
+	Graphics(std::move(graphics)),
 	isTouchEngineLoaded(false),
 	isTouchEngineReady(false),
 	isGraphicsContextLoaded(false),
@@ -96,6 +61,10 @@ FFGLTouchEnginePluginBase::FFGLTouchEnginePluginBase()
 	OffsetParamsByType = 4;
 
 	MaxParamsByType = 40;
+
+	// CHOP output slots follow the TouchEngine slots, plugin controls come last so adding one never shifts a mapped parameter
+	OutputParamsOffset = (MaxParamsByType * 7) + OffsetParamsByType;
+	ControlParamsOffset = OutputParamsOffset + MaxParamsByType;
 }
 
 FFGLTouchEnginePluginBase::~FFGLTouchEnginePluginBase()
@@ -112,52 +81,23 @@ FFGLTouchEnginePluginBase::~FFGLTouchEnginePluginBase()
 		}
 		instance.reset();
 	}
-#ifdef __APPLE__
-	MetalContext.reset();
-	MetalCommandQueue = nil;
-	MetalDevice = nil;
-#endif
+	if (Indexer != nullptr) {
+		Indexer->RemoveDirectory(ToxLibrary);
+	}
+	if (!DefaultInstanceName.empty()) {
+		OutputRegistry::Get().ReleaseName(DefaultInstanceName);
+	}
 }
 
 FFResult FFGLTouchEnginePluginBase::InitializeDevice()
 {
-#ifdef _WIN32
-	// Create D3D11 device
-	HRESULT hr = D3D11CreateDevice(
-		nullptr,
-		D3D_DRIVER_TYPE_HARDWARE,
-		nullptr,
-		0,
-		nullptr,
-		0,
-		D3D11_SDK_VERSION,
-		D3DDevice.GetAddressOf(),
-		nullptr,
-		nullptr
-	);
-	if (FAILED(hr)) {
-		return FailAndLog("Failed to create D3D11 device");
-	}
-#endif
-#ifdef __APPLE__
-	if (MetalDevice == nil) {
-		MetalDevice = MTLCreateSystemDefaultDevice();
-		if (MetalDevice == nil) {
-			return FailAndLog("Failed to create Metal device");
-		}
-		MetalCommandQueue = [MetalDevice newCommandQueue];
-		if (MetalCommandQueue == nil) {
-			return FailAndLog("Failed to create Metal command queue");
-		}
-	}
-#endif
-
-	return FF_SUCCESS;
+	return Graphics->InitializeDevice();
 }
 
-FFResult FFGLTouchEnginePluginBase::InitializeShader(const std::string& vertexShaderCode, const std::string& fragmentShaderCode)
+FFResult FFGLTouchEnginePluginBase::InitializeShader()
 {
-	if (!shader.Compile(vertexShaderCode, fragmentShaderCode)) {
+	// The plain 2D variant is used for input passthrough on every platform
+	if (!presentation.Prepare(0)) {
 		DeInitGL();
 		return FailAndLog("Failed to compile shader");
 
@@ -177,69 +117,166 @@ FFResult FFGLTouchEnginePluginBase::DeInitGL()
 	return FF_SUCCESS;
 }
 
-void FFGLTouchEnginePluginBase::InitializeGlTexture(GLuint& texture, uint16_t width, uint16_t height, GLenum type) {
-	if (texture != 0) {
-		glDeleteTextures(1, &texture);
-		texture = 0;
-	}
-
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, type, NULL);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glBindTexture(GL_TEXTURE_2D, 0);
+uint32_t FFGLTouchEnginePluginBase::GetOutputFeatures() const
+{
+	return GetAlphaFeatures() | Graphics->GetTextureFeatures();
 }
 
-bool FFGLTouchEnginePluginBase::LoadTEGraphicsContext(bool reload) {
-	if (isGraphicsContextLoaded && !reload) {
-		return true;
+uint32_t FFGLTouchEnginePluginBase::GetOutputFeatures(const TouchEngineOutput& output) const
+{
+	// Interop copies keep TouchEngine's rows, so any mismatch with the host is flipped while drawing
+	uint32_t features = GetOutputFeatures();
+	if (output.Origin != GetHostTextureOrigin()) {
+		features |= PresentationFlipY;
 	}
-
-	if (instance == nullptr) {
-		return false;
+	if (UpscaleFilterValue == UpscaleFilterBicubic && (output.Width < (int)currentViewport.width || output.Height < (int)currentViewport.height)) {
+		features |= PresentationBicubic;
 	}
+	if (output.ExtendedRange) {
+		features |= PresentationClampRange;
+	}
+	return features;
+}
 
+TETextureOrigin FFGLTouchEnginePluginBase::GetHostTextureOrigin() const
+{
+	return GetTextureOrientation() == TextureOrientation::TOP_LEFT ? TETextureOriginTopLeft : TETextureOriginBottomLeft;
+}
 
-	// Load the TouchEngine graphics context
-
-#ifdef _WIN32
-	if (D3DDevice == nullptr) {
-		FFGLLog::LogToHost("D3D11 Device Not Available, You Probably Failed Somewhere...In Your Life");
+FFResult FFGLTouchEnginePluginBase::SetControlParameter(uint32_t control, float value)
+{
+	switch (control) {
+	case ControlAlphaMode:
+		AlphaModeValue = static_cast<int32_t>(value);
+		break;
+	case ControlRenderScale:
+		RenderScale = std::min(std::max(value, 0.1f), 1.0f);
+		break;
+	case ControlUpscaleFilter:
+		UpscaleFilterValue = static_cast<int32_t>(value);
+		break;
+	case ControlAdaptiveQuality:
+		if (AdaptiveQualityEnabled != (value > 0.5f)) {
+			AdaptiveQualityEnabled = value > 0.5f;
+			QualityController.Reset();
+		}
+		break;
+	case ControlFrameBudget:
+		QualityController.SetBudget(value);
+		break;
+	case ControlTickDivisor:
+		TickDivisor = std::max(1, static_cast<int32_t>(value));
+		break;
+	case ControlTickRate:
+		TickRate = std::max(0.0f, value);
+		TickPhase = 0.0;
+		break;
+	case ControlFrameBlend:
+		FrameBlendEnabled = value > 0.5f;
+		break;
+	case ControlPulseSpread:
+		PulseSpreadEnabled = value > 0.5f;
+		break;
+	case ControlPage:
+		ShowPage(static_cast<uint32_t>(std::max(0.0f, value)));
+		break;
+	case ControlSnapshot:
+		SnapshotSlot = std::min(std::max(static_cast<int32_t>(value) - 1, 0), static_cast<int32_t>(SnapshotCount) - 1);
+		MorphTableValid = false;
+		break;
+	case ControlSnapshotStore:
+		if (value > 0.5f) {
+			CaptureSnapshot(SnapshotSlot);
+		}
+		break;
+	case ControlSnapshotRecall:
+		if (value > 0.5f) {
+			RecallSnapshot(SnapshotSlot);
+		}
+		break;
+	case ControlMorphTarget:
+		MorphTarget = std::min(std::max(static_cast<int32_t>(value) - 1, 0), static_cast<int32_t>(SnapshotCount) - 1);
+		MorphTableValid = false;
+		break;
+	case ControlMorph:
+		if (value != MorphAmount) {
+			MorphAmount = std::min(std::max(value, 0.0f), 1.0f);
+			MorphDirty = true;
+		}
+		break;
+	case ControlExternalControl:
+		if (ExternalControlEnabled != (value > 0.5f)) {
+			ExternalControlEnabled = value > 0.5f;
+			ExternalControlDirty = true;
+		}
+		break;
 	}
+	return FF_SUCCESS;
+}
 
-	TEResult result = TED3D11ContextCreate(D3DDevice.Get(), D3DContext.take());
-	if (result != TEResultSuccess) {
-		return false;
+float FFGLTouchEnginePluginBase::GetControlParameter(uint32_t control) const
+{
+	switch (control) {
+	case ControlAlphaMode:
+		return static_cast<float>(AlphaModeValue);
+	case ControlRenderScale:
+		return RenderScale;
+	case ControlUpscaleFilter:
+		return static_cast<float>(UpscaleFilterValue);
+	case ControlAdaptiveQuality:
+		return AdaptiveQualityEnabled ? 1.0f : 0.0f;
+	case ControlFrameBudget:
+		return static_cast<float>(QualityController.GetBudget());
+	case ControlTickDivisor:
+		return static_cast<float>(TickDivisor);
+	case ControlTickRate:
+		return TickRate;
+	case ControlFrameBlend:
+		return FrameBlendEnabled ? 1.0f : 0.0f;
+	case ControlPulseSpread:
+		return PulseSpreadEnabled ? 1.0f : 0.0f;
+	case ControlPage:
+		return static_cast<float>(ParameterPage);
+	case ControlSnapshot:
+		return static_cast<float>(SnapshotSlot + 1);
+	case ControlMorphTarget:
+		return static_cast<float>(MorphTarget + 1);
+	case ControlMorph:
+		return MorphAmount;
+	case ControlExternalControl:
+		return ExternalControlEnabled ? 1.0f : 0.0f;
+	default:
+		return 0;
 	}
+}
 
-	result = TEInstanceAssociateGraphicsContext(instance, D3DContext);
-	if (result != TEResultSuccess) {
-		return false;
+uint32_t FFGLTouchEnginePluginBase::GetAlphaFeatures() const
+{
+	switch (AlphaModeValue) {
+	case AlphaModePremultiply:
+		return PresentationPremultiply;
+	case AlphaModeUnpremultiply:
+		return PresentationUnpremultiply;
+	default:
+		return 0;
 	}
-	isGraphicsContextLoaded = true;
-#endif
-#ifdef __APPLE__
-	if (MetalDevice == nil) {
-		FFGLLog::LogToHost("Metal Device Not Available");
-		return false;
+}
+
+bool FFGLTouchEnginePluginBase::LoadTEGraphicsContext(bool reload) {
+	if (isGraphicsContextLoaded && !reload) {
+		return true;
 	}
 
-	TEResult result = TEMetalContextCreate(MetalDevice, MetalContext.take());
-	if (result != TEResultSuccess) {
-		FFGLLog::LogToHost("Failed to create TEMetalContext");
+	if (instance == nullptr) {
 		return false;
 	}
 
-	result = TEInstanceAssociateGraphicsContext(instance, MetalContext);
-	if (result != TEResultSuccess) {
-		FFGLLog::LogToHost("Failed to associate Metal graphics context");
+
+	// Load the TouchEngine graphics context
+	if (!Graphics->AssociateContext(instance)) {
 		return false;
 	}
 	isGraphicsContextLoaded = true;
-#endif
 	return isGraphicsContextLoaded;
 }
 
@@ -289,6 +326,10 @@ void FFGLTouchEnginePluginBase::LoadTouchEngine() {
 			return;
 		}
 
+		if (TEInstanceSetStatisticsCallback(instance, statisticsCallbackStatic) != TEResultSuccess) {
+			FFGLLog::LogToHost("Failed to set TouchEngine statistics callback, adaptive quality will use frame latency");
+		}
+
 	}
 
 }
@@ -302,7 +343,9 @@ FFResult FFGLTouchEnginePluginBase::SetFloatParameter(unsigned int dwIndex, floa
 	}
 
 	if (dwIndex == 2 && value == 1) {
-		if (isTouchEngineLoaded) {
+		if (instance != nullptr && isTouchEngineLoaded) {
+			isTouchEngineLoaded = false;
+			isTouchEngineReady = false;
 			TEInstanceSuspend(instance);
 			TEInstanceUnload(instance);
 		}
@@ -316,34 +359,55 @@ FFResult FFGLTouchEnginePluginBase::SetFloatParameter(unsigned int dwIndex, floa
 		return FF_SUCCESS;
 	}
 
+	if (dwIndex >= ControlParamsOffset) {
+		return SetControlParameter(dwIndex - ControlParamsOffset, value);
+	}
+
+	// Output slots are driven by TouchEngine, host writes are ignored
+	if (dwIndex >= OutputParamsOffset) {
+		return FF_SUCCESS;
+	}
+
 	if (!isTouchEngineLoaded || !isTouchEngineReady) {
 		return FF_SUCCESS;
 	}
 
-	if (ActiveParams.find(dwIndex) == ActiveParams.end()) {
+	FFUInt32 ParamID = SlotToParameter(dwIndex);
+	if (ActiveParams.find(ParamID) == ActiveParams.end()) {
 		return FF_SUCCESS;
 	}
 
-	FFUInt32 type = ParameterMapType[dwIndex];
+	FFUInt32 type = ParameterMapType[ParamID];
 
 
 	if (type == FF_TYPE_INTEGER) {
-		ParameterMapInt[dwIndex] = static_cast<int32_t>(value);
+		ParameterMapInt[ParamID] = static_cast<int32_t>(value);
 		return FF_SUCCESS;
 	}
 
 	if (type == FF_TYPE_BOOLEAN || type == FF_TYPE_EVENT) {
-		ParameterMapBool[dwIndex] = value;
+		// A pulse fires on the press, the release that often follows before the next frame must not cancel it
+		auto pulse = PulseQueues.find(ParamID);
+		if (pulse != PulseQueues.end() && value > 0.5f && !ParameterMapBool[ParamID]) {
+			if (!pulse->second->Push(GetSteadyTimeNs())) {
+				FFGLLog::LogToHost("Pulse queue full, dropping a pulse");
+			}
+		}
+		ParameterMapBool[ParamID] = value;
 		return FF_SUCCESS;
 	}
 
 	if (type == FF_TYPE_OPTION) {
-		ParameterMapInt[dwIndex] = static_cast<int32_t>(value);
+		ParameterMapInt[ParamID] = static_cast<int32_t>(value);
 		return FF_SUCCESS;
 	}
 
 
-	ParameterMapFloat[dwIndex] = value;
+	ParameterMapFloat[ParamID] = value;
+
+	if (!AutomationLink.empty()) {
+		RecordAutomation(ParamID, value, GetSteadyTimeNs());
+	}
 
 	return FF_SUCCESS;
 }
@@ -351,49 +415,120 @@ FFResult FFGLTouchEnginePluginBase::SetFloatParameter(unsigned int dwIndex, floa
 FFResult FFGLTouchEnginePluginBase::SetTextParameter(unsigned int dwIndex, const char* value) {
 	switch (dwIndex) {
 	case 0:
+	{
 		// Open file dialog
 		FilePath = std::string(value);
+		ClaimDefaultInstanceName();
+
+		// An indexed tox shows its parameters right away, TouchEngine fills in the values once loaded
+		ToxSchema schema;
+		if (Indexer->FindSchema(FilePath, schema)) {
+			ExposeSchema(schema);
+		}
+
 		LoadTEFile();
 		return FF_SUCCESS;
 	}
+	}
+
+	if (dwIndex == ControlParamsOffset + ControlToxLibrary) {
+		// The indexer keeps every layer's library, this one only swaps its own
+		std::string library = value != nullptr ? value : "";
+		if (library != ToxLibrary) {
+			Indexer->RemoveDirectory(ToxLibrary);
+			ToxLibrary = library;
+			Indexer->AddDirectory(ToxLibrary);
+		}
+		return FF_SUCCESS;
+	}
+
+	if (dwIndex == ControlParamsOffset + ControlInstanceName) {
+		InstanceName = value != nullptr ? value : "";
+		// Before the tox has loaded there is nothing to publish, GetAllParameters publishes under the new name
+		if (isTouchEngineLoaded) {
+			PublishOutputs();
+		}
+		ExternalControlDirty = true;
+		return FF_SUCCESS;
+	}
+
+	if (dwIndex == ControlParamsOffset + ControlOutputSelect) {
+		OutputSelect = value != nullptr ? value : "";
+		return FF_SUCCESS;
+	}
 
 	if (!isTouchEngineLoaded || !isTouchEngineReady) {
 		return FF_SUCCESS;
 	}
 
-	if (ActiveParams.find(dwIndex) == ActiveParams.end()) {
+	FFUInt32 ParamID = SlotToParameter(dwIndex);
+	if (ActiveParams.find(ParamID) == ActiveParams.end()) {
 		return FF_SUCCESS;
 	}
-	ParameterMapString[dwIndex] = value;
+
+	// DAT outputs are only written by TouchEngine
+	{
+		std::lock_guard<std::mutex> lock(OutputsMutex);
+		for (auto& output : TableOutputs) {
+			if (output.ParamID == ParamID) {
+				return FF_SUCCESS;
+			}
+		}
+	}
+
+	ParameterMapString[ParamID] = value;
 	return FF_SUCCESS;
 }
 
+FFUInt32 FFGLTouchEnginePluginBase::SetParamElementValue(unsigned int dwIndex, unsigned int elIndex, float newValue) {
+	// FFT bins go straight into the buffer sent to TouchEngine, nobody reads them back from the parameter
+	if (dwIndex == ControlParamsOffset + ControlAudioFFT) {
+		if (elIndex >= AudioFFTValues.size()) {
+			return FF_FAIL;
+		}
+		AudioFFTValues[elIndex] = newValue;
+		return FF_SUCCESS;
+	}
+
+	return CFFGLPlugin::SetParamElementValue(dwIndex, elIndex, newValue);
+}
+
 float FFGLTouchEnginePluginBase::GetFloatParameter(unsigned int dwIndex) {
 
 	if (dwIndex == 1) {
 		return 0;
 	}
+
+	if (dwIndex >= ControlParamsOffset) {
+		return GetControlParameter(dwIndex - ControlParamsOffset);
+	}
+
+	if (dwIndex >= OutputParamsOffset) {
+		return OutputParamValues[dwIndex - OutputParamsOffset];
+	}
+
 	if (!isTouchEngineLoaded || !isTouchEngineReady) {
 		return 0;
 
 	}
 
-	if (ActiveParams.find(dwIndex) == ActiveParams.end()) {
+	FFUInt32 ParamID = SlotToParameter(dwIndex);
+	if (ActiveParams.find(ParamID) == ActiveParams.end()) {
 		return 0;
 	}
 
-	FFUInt32 type = ParameterMapType[dwIndex];
+	FFUInt32 type = ParameterMapType[ParamID];
 
 	if (type == FF_TYPE_INTEGER) {
-		return static_cast<float>(ParameterMapInt[dwIndex]);
+		return static_cast<float>(ParameterMapInt[ParamID]);
 	}
 
 	if (type == FF_TYPE_BOOLEAN || type == FF_TYPE_EVENT) {
-		return ParameterMapBool[dwIndex];
+		return ParameterMapBool[ParamID];
 	}
 
 
-	return static_cast<float>(ParameterMapFloat[dwIndex]);
+	return static_cast<float>(ParameterMapFloat[ParamID]);
 }
 
 char* FFGLTouchEnginePluginBase::GetTextParameter(unsigned int dwIndex) {
@@ -401,15 +536,28 @@ char* FFGLTouchEnginePluginBase::GetTextParameter(unsigned int dwIndex) {
 		return (char*)FilePath.c_str();
 	}
 
+	if (dwIndex == ControlParamsOffset + ControlInstanceName) {
+		return (char*)InstanceName.c_str();
+	}
+
+	if (dwIndex == ControlParamsOffset + ControlOutputSelect) {
+		return (char*)OutputSelect.c_str();
+	}
+
+	if (dwIndex == ControlParamsOffset + ControlToxLibrary) {
+		return (char*)ToxLibrary.c_str();
+	}
+
 	if (!isTouchEngineLoaded || !isTouchEngineReady) {
 		return nullptr;
 	}
 
-	if (ActiveParams.find(dwIndex) == ActiveParams.end()) {
+	FFUInt32 ParamID = SlotToParameter(dwIndex);
+	if (ActiveParams.find(ParamID) == ActiveParams.end()) {
 		return nullptr;
 	}
 
-	return (char*)ParameterMapString[dwIndex].c_str();
+	return (char*)ParameterMapString[ParamID].c_str();
 }
 
 void FFGLTouchEnginePluginBase::ConstructBaseParameters() {
@@ -460,23 +608,119 @@ void FFGLTouchEnginePluginBase::ConstructBaseParameters() {
 		SetParamVisibility(colorBase + i + 2, false, false);
 		SetParamVisibility(colorBase + i + 3, false, false);
 	}
+
+	// SetParamInfof reads the default back through GetFloatParameter, so the values must exist first
+	OutputParamValues.assign(MaxParamsByType, 0.0f);
+	for (uint32_t i = OutputParamsOffset; i < OutputParamsOffset + MaxParamsByType; i++) {
+		SetParamInfof(i, (std::string("Output") + std::to_string(i)).c_str(), FF_TYPE_STANDARD);
+		SetParamVisibility(i, false, false);
+	}
+
+	SetOptionParamInfo(ControlParamsOffset + ControlAlphaMode, "Alpha", 3, AlphaModeStraight);
+	SetParamElementInfo(ControlParamsOffset + ControlAlphaMode, AlphaModeStraight, "Straight", AlphaModeStraight);
+	SetParamElementInfo(ControlParamsOffset + ControlAlphaMode, AlphaModePremultiply, "Premultiply", AlphaModePremultiply);
+	SetParamElementInfo(ControlParamsOffset + ControlAlphaMode, AlphaModeUnpremultiply, "Unpremultiply", AlphaModeUnpremultiply);
+
+	SetParamInfo(ControlParamsOffset + ControlRenderScale, "Render Scale", FF_TYPE_STANDARD, 1.0f);
+	SetParamRange(ControlParamsOffset + ControlRenderScale, 0.1f, 1.0f);
+
+	SetOptionParamInfo(ControlParamsOffset + ControlUpscaleFilter, "Upscale", 2, UpscaleFilterBilinear);
+	SetParamElementInfo(ControlParamsOffset + ControlUpscaleFilter, UpscaleFilterBilinear, "Bilinear", UpscaleFilterBilinear);
+	SetParamElementInfo(ControlParamsOffset + ControlUpscaleFilter, UpscaleFilterBicubic, "Bicubic", UpscaleFilterBicubic);
+
+	SetParamInfo(ControlParamsOffset + ControlAdaptiveQuality, "Adaptive Quality", FF_TYPE_BOOLEAN, false);
+
+	SetParamInfo(ControlParamsOffset + ControlFrameBudget, "Frame Budget (ms)", FF_TYPE_STANDARD, 16.0f);
+	SetParamRange(ControlParamsOffset + ControlFrameBudget, 1.0f, 100.0f);
+
+	SetParamInfo(ControlParamsOffset + ControlTickDivisor, "TE Rate Divisor", FF_TYPE_INTEGER, 1.0f);
+	SetParamRange(ControlParamsOffset + ControlTickDivisor, 1.0f, 8.0f);
+
+	SetParamInfo(ControlParamsOffset + ControlTickRate, "TE Rate (Hz)", FF_TYPE_STANDARD, 0.0f);
+	SetParamRange(ControlParamsOffset + ControlTickRate, 0.0f, 240.0f);
+
+	SetParamInfo(ControlParamsOffset + ControlFrameBlend, "Frame Blend", FF_TYPE_BOOLEAN, false);
+
+	SetParamInfo(ControlParamsOffset + ControlInstanceName, "Instance Name", FF_TYPE_TEXT, "");
+	SetParamInfo(ControlParamsOffset + ControlOutputSelect, "Output", FF_TYPE_TEXT, "");
+
+	SetBufferParamInfo(ControlParamsOffset + ControlAudioFFT, "Audio FFT", AudioFFTBins, FF_USAGE_FFT);
+	AudioFFTValues.resize(AudioFFTBins);
+
+	SetParamInfo(ControlParamsOffset + ControlPulseSpread, "Pulse Spread", FF_TYPE_BOOLEAN, true);
+
+	SetOptionParamInfo(ControlParamsOffset + ControlPage, "Page", 1, 0);
+	SetParamElementInfo(ControlParamsOffset + ControlPage, 0, "1", 0);
+
+	SetParamInfo(ControlParamsOffset + ControlSnapshot, "Snapshot", FF_TYPE_INTEGER, 1.0f);
+	SetParamRange(ControlParamsOffset + ControlSnapshot, 1.0f, static_cast<float>(SnapshotCount));
+	SetParamInfof(ControlParamsOffset + ControlSnapshotStore, "Store Snapshot", FF_TYPE_EVENT);
+	SetParamInfof(ControlParamsOffset + ControlSnapshotRecall, "Recall Snapshot", FF_TYPE_EVENT);
+	SetParamInfo(ControlParamsOffset + ControlMorphTarget, "Morph To", FF_TYPE_INTEGER, 2.0f);
+	SetParamRange(ControlParamsOffset + ControlMorphTarget, 1.0f, static_cast<float>(SnapshotCount));
+	SetParamInfo(ControlParamsOffset + ControlMorph, "Morph", FF_TYPE_STANDARD, 0.0f);
+	Snapshots.resize(SnapshotCount);
+	SnapshotWriter = SnapshotBankWriter::Acquire();
+
+	SetParamInfo(ControlParamsOffset + ControlExternalControl, "External Control", FF_TYPE_BOOLEAN, false);
+
+	SetParamInfo(ControlParamsOffset + ControlToxLibrary, "Tox Library", FF_TYPE_TEXT, "");
+	Indexer = ToxIndexer::Acquire();
 }
 
 void FFGLTouchEnginePluginBase::ResetBaseParameters() {
-	for (auto& ParamID : ActiveParams) {
-		SetParamVisibility(ParamID, false, true);
+	// Every exposed parameter has a layout, including the ones shown from a cached schema
+	for (auto& layout : ParameterLayouts) {
+		if (IsOnPage(layout.first)) {
+			SetParamVisibility(layout.first % PageStride, false, true);
+		}
+	}
+	ParameterLayouts.clear();
+	BlockCounts.fill(0);
+	MorphTableValid = false;
+	PageCount = 1;
+	UpdatePageControl();
+
+	{
+		std::lock_guard<std::mutex> lock(OutputsMutex);
+		for (uint32_t i = 0; i < OutputParamCount; i++) {
+			SetParamVisibility(OutputParamsOffset + i, false, true);
+			OutputParamValues[i] = 0.0f;
+		}
+		ChannelOutputs.clear();
+		TableOutputs.clear();
+		OutputParamCount = 0;
 	}
 
 	hasVideoOutput = false;
+	RetireOutputs();
+	RenderWidthLink.clear();
+	RenderHeightLink.clear();
+	AudioFFTLink.clear();
+	BpmLink.clear();
+	BarPhaseLink.clear();
+	SentBpm = -1.0;
+	PackedParamsLink.clear();
+	PackedParams.clear();
+	PackedNames.clear();
+	PackedBuffer.reset();
+	PackedSent = false;
+	AutomationLink.clear();
+	AutomationChannels.clear();
+	AutomationIndex.clear();
+	AutomationBuffer.reset();
+	LastAutomationNs = 0;
+	SentRenderWidth = 0;
+	SentRenderHeight = 0;
 	ActiveParams.clear();
 	ActiveVectorParams.clear();
 	VectorParameters.clear();
 	ParameterMapFloat.clear();
 	ParameterMapInt.clear();
 	ParameterMapString.clear();
+	TableInputs.clear();
 	ParameterMapBool.clear();
-	PulseParameters.clear();
-	ColorParamCount = 0;
+	PulseQueues.clear();
 	Parameters.clear();
 }
 
@@ -513,18 +757,14 @@ void FFGLTouchEnginePluginBase::GetAllParameters() {
 
 
 			if (linkInfo->domain == TELinkDomainParameter) {
-
-				if (ActiveParams.size() > MaxParamsByType * 6) {
-					FFGLLog::LogToHost("Too many parameters, skipping");
-					continue;
-				}
-
 				if (linkInfo->type == TELinkTypeGroup) {
 					CreateParametersFromGroup(linkInfo);
 				} else {
 					CreateIndividualParameter(linkInfo);
 				}
-			} else if (linkInfo->domain == TELinkDomainOperator) {
+			} else if (linkInfo->domain == TELinkDomainOperator && linkInfo->type == TELinkTypeStringData) {
+				CreateTableParameter(linkInfo);
+			} else if (linkInfo->domain == TELinkDomainOperator && !HandleReservedLink(linkInfo)) {
 				HandleOperatorLink(linkInfo);
 			}
 
@@ -554,24 +794,29 @@ void FFGLTouchEnginePluginBase::GetAllParameters() {
 				continue;
 			}
 
-			if (linkInfo->domain == TELinkDomainOperator) {
-				if (strcmp(linkInfo->name, "out1") == 0 && linkInfo->type == TELinkTypeTexture) {
-					OutputOpName = linkInfo->identifier;
-					hasVideoOutput = true;
-					break;
-				} else if (linkInfo->type == TELinkTypeTexture) {
-					OutputOpName = linkInfo->identifier;
-					hasVideoOutput = true;
-					break;
-				}
+			if (linkInfo->domain == TELinkDomainOperator && linkInfo->type == TELinkTypeTexture) {
+				RegisterOutput(linkInfo);
+			} else if (linkInfo->domain == TELinkDomainOperator && linkInfo->type == TELinkTypeFloatBuffer) {
+				RegisterChannelOutput(linkInfo);
+			} else if (linkInfo->domain == TELinkDomainOperator && linkInfo->type == TELinkTypeStringData) {
+				RegisterTableOutput(linkInfo);
 			}
 		}
 
 	}
+
+	PublishOutputs();
+	UpdatePageControl();
+	LoadSnapshots();
+	ExternalControlDirty = true;
 }
 
 void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELinkInfo>& linkInfo) {
 
+	if (HandleReservedLink(linkInfo)) {
+		return;
+	}
+
 	switch (linkInfo->type) {
 	case TELinkTypeTexture:
 	case TELinkTypeGroup:
@@ -580,6 +825,12 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 		return;
 	}
 
+	case TELinkTypeStringData:
+	{
+		CreateTableParameter(linkInfo);
+		return;
+	}
+
 	TEResult result;
 
 	case TELinkTypeDouble:
@@ -623,21 +874,18 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 
 			static const FFUInt32 colorTypes[] = { FF_TYPE_RED, FF_TYPE_GREEN, FF_TYPE_BLUE, FF_TYPE_ALPHA };
 
-			// Align to start of a group of 4 so R/G/B/A land on the correct pre-allocated types
-			uint32_t colorGroupBase = (ColorParamCount / 4) * 4;
-			if (ColorParamCount % 4 != 0) {
-				colorGroupBase = ColorParamCount; // already mid-group shouldn't happen, but advance
-			}
+			// Colors take a whole group of 4 slots so R/G/B/A land on the correct pre-allocated types
+			FFUInt32 colorBase = linkInfo->intent == TELinkIntentColorRGBA ? AllocateParameter(ParamBlockColor, 4) : 0;
 
 			for (uint32_t i = 0; i < linkInfo->count; i++) {
 				uint32_t ParamID;
 
 				if (linkInfo->intent == TELinkIntentColorRGBA && i < 4) {
 					// Use pre-allocated color picker slots (aligned to groups of 4)
-					ParamID = (MaxParamsByType * 6) + OffsetParamsByType + colorGroupBase + i;
+					ParamID = colorBase + i;
 					ParameterMapType[ParamID] = colorTypes[i];
 				} else {
-					ParamID = Parameters.size() + OffsetParamsByType;
+					ParamID = AllocateParameter(ParamBlockFloat);
 					ParameterMapType[ParamID] = FF_TYPE_STANDARD;
 				}
 
@@ -647,30 +895,23 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 				info.children[i] = ParamID;
 
 				ParameterMapFloat[ParamID] = value[i];
-				SetParamDisplayName(ParamID, linkInfo->label + std::string(".") + Suffix[i], true);
-				SetParamRange(ParamID, min[i], max[i]);
-				RaiseParamEvent(ParamID, FF_EVENT_FLAG_VALUE);
-				SetParamVisibility(ParamID, true, true);
-
-			}
+				ExposeParameter(ParamID, linkInfo->label + std::string(".") + Suffix[i], static_cast<float>(min[i]), static_cast<float>(max[i]));
 
-			// Advance color counter by a full group of 4 to keep alignment
-			if (linkInfo->intent == TELinkIntentColorRGBA) {
-				ColorParamCount = colorGroupBase + 4;
 			}
 
 			VectorParameters.push_back(info);
 
 			return;
 		}
-		uint32_t ParamID = Parameters.size() + OffsetParamsByType;
+		uint32_t ParamID = AllocateParameter(ParamBlockFloat);
 		Parameters.push_back(std::make_pair(linkInfo->identifier, ParamID));
 		ActiveParams.insert(ParamID);
 		ParameterMapType[ParamID] = FF_TYPE_STANDARD;
+		PackedParams.push_back(ParamID);
+		PackedNames.push_back(linkInfo->name);
 
 		//SetParamInfof(Parameters[j].second, linkInfo->name, FF_TYPE_STANDARD);
 
-		SetParamDisplayName(ParamID, linkInfo->label, true);
 
 		double value = 0;
 		result = TEInstanceLinkGetDoubleValue(instance, linkInfo->identifier, TELinkValueCurrent, &value, 1);
@@ -691,9 +932,7 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 			return;
 		}
 
-		SetParamRange(ParamID, min, max);
-		RaiseParamEvent(ParamID, FF_EVENT_FLAG_VALUE);
-		SetParamVisibility(ParamID, true, true);
+		ExposeParameter(ParamID, linkInfo->label, min, max);
 
 		break;
 
@@ -702,7 +941,7 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 	{
 		if (TEInstanceLinkHasChoices(instance, linkInfo->identifier)) {
 			TouchObject<TEStringArray> labels;
-			uint32_t ParamID = (ParameterMapInt.size() + OffsetParamsByType) + (MaxParamsByType * 5);
+			uint32_t ParamID = AllocateParameter(ParamBlockOption);
 			result = TEInstanceLinkGetChoiceLabels(instance, linkInfo->identifier, labels.take());
 			if (result != TEResultSuccess && !labels) {
 				return;
@@ -716,7 +955,6 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 				valuesVector.push_back(static_cast<float>(k));
 			}
 
-			SetParamElements(ParamID, labelsVector, valuesVector, true);
 
 			int32_t value = 0;
 			result = TEInstanceLinkGetIntValue(instance, linkInfo->identifier, TELinkValueCurrent, &value, 1);
@@ -726,14 +964,12 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 
 			Parameters.push_back(std::make_pair(linkInfo->identifier, ParamID));
 			ActiveParams.insert(ParamID);
-			SetParamDisplayName(ParamID, linkInfo->label, true);
 			ParameterMapType[ParamID] = FF_TYPE_OPTION;
 
-			RaiseParamEvent(ParamID, FF_EVENT_FLAG_VALUE);
-			SetParamVisibility(ParamID, true, true);
+			ExposeParameter(ParamID, linkInfo->label, labelsVector, valuesVector);
 			break;
 		} else {
-			uint32_t ParamID = (ParameterMapInt.size() + OffsetParamsByType) + MaxParamsByType;
+			uint32_t ParamID = AllocateParameter(ParamBlockInt);
 			Parameters.push_back(std::make_pair(linkInfo->identifier, ParamID));
 			ActiveParams.insert(ParamID);
 			ParameterMapType[ParamID] = FF_TYPE_INTEGER;
@@ -743,7 +979,6 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 			if (result != TEResultSuccess) {
 				return;
 			}
-			SetParamDisplayName(ParamID, linkInfo->label, true);
 			ParameterMapInt[ParamID] = value;
 
 
@@ -759,9 +994,7 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 				return;
 			}
 
-			SetParamRange(ParamID, static_cast<float>(min), static_cast<float>(max));
-			RaiseParamEvent(ParamID, FF_EVENT_FLAG_VALUE);
-			SetParamVisibility(ParamID, true, true);
+			ExposeParameter(ParamID, linkInfo->label, static_cast<float>(min), static_cast<float>(max));
 
 			break;
 		}
@@ -770,13 +1003,13 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 	{
 
 		if (linkInfo->intent == TELinkIntentMomentary || linkInfo->intent == TELinkIntentPulse) {
-			uint32_t ParamID = (ParameterMapBool.size() + OffsetParamsByType) + (MaxParamsByType * 4);
+			uint32_t ParamID = AllocateParameter(ParamBlockPulse);
 			Parameters.push_back(std::make_pair(linkInfo->identifier, ParamID));
 			ActiveParams.insert(ParamID);
 			ParameterMapType[ParamID] = FF_TYPE_EVENT;
 
 			if (linkInfo->intent == TELinkIntentPulse) {
-				PulseParameters.insert(ParamID);
+				PulseQueues[ParamID] = std::make_unique<TriggerQueue>();
 			}
 
 			bool value = false;
@@ -785,13 +1018,11 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 				return;
 			}
 
-			SetParamDisplayName(ParamID, linkInfo->label, true);
 			ParameterMapBool[ParamID] = value;
-			RaiseParamEvent(ParamID, FF_EVENT_FLAG_VALUE);
-			SetParamVisibility(ParamID, true, true);
+			ExposeParameter(ParamID, linkInfo->label);
 		} else {
 			//SetParamInfof(Parameters[j].second, linkInfo->name, FF_TYPE_BOOLEAN);
-			uint32_t ParamID = (ParameterMapBool.size() + OffsetParamsByType) + MaxParamsByType * 2;
+			uint32_t ParamID = AllocateParameter(ParamBlockBool);
 			Parameters.push_back(std::make_pair(linkInfo->identifier, ParamID));
 			ActiveParams.insert(ParamID);
 			ParameterMapType[ParamID] = FF_TYPE_BOOLEAN;
@@ -803,17 +1034,15 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 			}
 
 			//SetParamInfo(Parameters[j].second, linkInfo->name, FF_TYPE_BOOLEAN, value);
-			SetParamDisplayName(ParamID, linkInfo->label, true);
 			ParameterMapBool[ParamID] = value;
-			RaiseParamEvent(ParamID, FF_EVENT_FLAG_VALUE);
-			SetParamVisibility(ParamID, true, true);
+			ExposeParameter(ParamID, linkInfo->label);
 		}
 
 		break;
 	}
 	case TELinkTypeString:
 	{
-		uint32_t ParamID = (ParameterMapString.size() + OffsetParamsByType) + MaxParamsByType * 3; //(MaxParamsByType * 3) + OffsetParamsByType
+		uint32_t ParamID = AllocateParameter(ParamBlockText);
 		Parameters.push_back(std::make_pair(linkInfo->identifier, ParamID));
 		ActiveParams.insert(ParamID);
 		ParameterMapType[ParamID] = FF_TYPE_TEXT;
@@ -823,10 +1052,8 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 		if (result != TEResultSuccess) {
 			return;
 		}
-		SetParamDisplayName(ParamID, linkInfo->label, true);
 		ParameterMapString[ParamID] = value->string;
-		RaiseParamEvent(ParamID, FF_EVENT_FLAG_VALUE);
-		SetParamVisibility(ParamID, true, true);
+		ExposeParameter(ParamID, linkInfo->label);
 		//SetParamInfo(Parameters[j].second, linkInfo->name, FF_TYPE_TEXT, value);
 
 
@@ -837,94 +1064,1371 @@ void FFGLTouchEnginePluginBase::CreateIndividualParameter(const TouchObject<TELi
 
 }
 
-void FFGLTouchEnginePluginBase::CreateParametersFromGroup(const TouchObject<TELinkInfo>& linkInfo) {
+bool FFGLTouchEnginePluginBase::HandleReservedLink(const TouchObject<TELinkInfo>& linkInfo) {
+	if (linkInfo->name == nullptr) {
+		return false;
+	}
 
-	TouchObject<TEStringArray> links;
-	TEResult result = TEInstanceLinkGetChildren(instance, linkInfo->identifier, links.take());
+	// Fed from the host's FFT buffer parameter
+	if (linkInfo->domain == TELinkDomainOperator && linkInfo->type == TELinkTypeFloatBuffer && strcmp(linkInfo->name, "audiofft") == 0) {
+		AudioFFTLink = linkInfo->identifier;
+		return true;
+	}
 
-	if (result != TEResultSuccess) {
-		return;
+	// Receives float parameter changes as time-dependent samples
+	if (linkInfo->domain == TELinkDomainOperator && linkInfo->type == TELinkTypeFloatBuffer && strcmp(linkInfo->name, "automation") == 0) {
+		AutomationLink = linkInfo->identifier;
+		return true;
 	}
 
-	for (int j = 0; j < links->count; j++) {
-		TouchObject<TELinkInfo> linkInfo;
-		result = TEInstanceLinkGetInfo(instance, links->strings[j], linkInfo.take());
+	// Receives every scalar float parameter in one buffer instead of one link call each
+	if (linkInfo->domain == TELinkDomainOperator && linkInfo->type == TELinkTypeFloatBuffer && strcmp(linkInfo->name, "params") == 0) {
+		PackedParamsLink = linkInfo->identifier;
+		return true;
+	}
 
-		if (result != TEResultSuccess) {
-			continue;
-			FFGLLog::LogToHost("Failed to get link info");
+	// Driven by the host's beat info
+	if (linkInfo->domain == TELinkDomainParameter && linkInfo->type == TELinkTypeDouble && linkInfo->count == 1) {
+		if (strcmp(linkInfo->name, "Bpm") == 0) {
+			BpmLink = linkInfo->identifier;
+			return true;
+		}
 
+		if (strcmp(linkInfo->name, "Barphase") == 0) {
+			BarPhaseLink = linkInfo->identifier;
+			return true;
 		}
+	}
 
-		CreateIndividualParameter(linkInfo);
+	if (linkInfo->type != TELinkTypeInt) {
+		return false;
 	}
 
+	// Driven by the render scale control rather than exposed to the host
+	if (strcmp(linkInfo->name, "Renderwidth") == 0) {
+		RenderWidthLink = linkInfo->identifier;
+		return true;
+	}
 
+	if (strcmp(linkInfo->name, "Renderheight") == 0) {
+		RenderHeightLink = linkInfo->identifier;
+		return true;
+	}
 
+	return false;
 }
 
-FFResult FFGLTouchEnginePluginBase::PushParametersToTouchEngine()
-{
-	if (instance == nullptr) {
+FFResult FFGLTouchEnginePluginBase::PushRenderResolution() {
+	if (RenderWidthLink.empty() && RenderHeightLink.empty()) {
 		return FF_SUCCESS;
 	}
 
-	for (auto& param : Parameters) {
-		FFUInt32 type = ParameterMapType[param.second];
+	float scale = GetEffectiveRenderScale();
+	int32_t width = std::max(1, static_cast<int32_t>(currentViewport.width * scale + 0.5f));
+	int32_t height = std::max(1, static_cast<int32_t>(currentViewport.height * scale + 0.5f));
 
-		if (ActiveVectorParams.find(param.second) != ActiveVectorParams.end()) {
-			continue;
+	if (!RenderWidthLink.empty() && width != SentRenderWidth) {
+		if (TEInstanceLinkSetIntValue(instance, RenderWidthLink.c_str(), &width, 1) != TEResultSuccess) {
+			return FF_FAIL;
 		}
+		SentRenderWidth = width;
+	}
 
-		if (type == FF_TYPE_STANDARD) {
-			TEResult result = TEInstanceLinkSetDoubleValue(instance, param.first.c_str(), &ParameterMapFloat[param.second], 1);
-			if (result != TEResultSuccess) {
-				isTouchFrameBusy = false;
-				return FailAndLog("Failed to set double value");
-			}
+	if (!RenderHeightLink.empty() && height != SentRenderHeight) {
+		if (TEInstanceLinkSetIntValue(instance, RenderHeightLink.c_str(), &height, 1) != TEResultSuccess) {
+			return FF_FAIL;
 		}
+		SentRenderHeight = height;
+	}
 
-		if (type == FF_TYPE_INTEGER || type == FF_TYPE_OPTION) {
-			TEResult result = TEInstanceLinkSetIntValue(instance, param.first.c_str(), &ParameterMapInt[param.second], 1);
-			if (result != TEResultSuccess) {
-				isTouchFrameBusy = false;
-				return FailAndLog("Failed to set int value");
-			}
-		}
+	return FF_SUCCESS;
+}
 
+FFResult FFGLTouchEnginePluginBase::PushAudioFFT() {
+	if (AudioFFTLink.empty()) {
+		return FF_SUCCESS;
+	}
 
-		if (type == FF_TYPE_BOOLEAN || type == FF_TYPE_EVENT) {
-			TEResult result = TEInstanceLinkSetBooleanValue(instance, param.first.c_str(), ParameterMapBool[param.second]);
-			if (result != TEResultSuccess) {
-				isTouchFrameBusy = false;
-				return FailAndLog("Failed to set boolean value");
-			}
-			// Auto-reset pulse parameters to false after sending
-			if (ParameterMapBool[param.second] && PulseParameters.find(param.second) != PulseParameters.end()) {
-				ParameterMapBool[param.second] = false;
-			}
+	if (AudioFFTBuffer == nullptr) {
+		AudioFFTBuffer.take(TEFloatBufferCreate(static_cast<double>(AudioSampleRate), 1, AudioFFTBins, nullptr));
+		if (AudioFFTBuffer == nullptr) {
+			return FF_FAIL;
 		}
+	}
 
-		if (type == FF_TYPE_TEXT) {
-			TEResult result = TEInstanceLinkSetStringValue(instance, param.first.c_str(), ParameterMapString[param.second].c_str());
-			if (result != TEResultSuccess) {
-				isTouchFrameBusy = false;
-				return FailAndLog("Failed to set string value");
-			}
-		}
+	const float* channels[] = { AudioFFTValues.data() };
+	if (TEFloatBufferSetValues(AudioFFTBuffer, channels, AudioFFTBins) != TEResultSuccess) {
+		return FF_FAIL;
+	}
 
+	// Required every frame even though the same buffer object is reused
+	if (TEInstanceLinkSetFloatBufferValue(instance, AudioFFTLink.c_str(), AudioFFTBuffer) != TEResultSuccess) {
+		return FF_FAIL;
 	}
 
-	for (auto& param : VectorParameters) {
-		double values[4] = { 0,0,0,0 };
+	return FF_SUCCESS;
+}
 
-		for (uint8_t i = 0; i < param.count; i++) {
-			values[i] = ParameterMapFloat[param.children[i]];
+FFResult FFGLTouchEnginePluginBase::PushPackedParameters() {
+	if (PackedParamsLink.empty() || PackedParams.empty()) {
+		return FF_SUCCESS;
+	}
+
+	if (PackedBuffer == nullptr) {
+		std::vector<const char*> names;
+		for (auto& name : PackedNames) {
+			names.push_back(name.c_str());
 		}
 
-		TEResult result = TEInstanceLinkSetDoubleValue(instance, param.identifier.c_str(), values, param.count);
-		if (result != TEResultSuccess) {
-			isTouchFrameBusy = false;
+		// Not time-dependent and one sample per channel, CHOP channel names follow the tox parameters
+		PackedBuffer.take(TEFloatBufferCreate(-1.0, static_cast<int32_t>(PackedParams.size()), 1, names.data()));
+		if (PackedBuffer == nullptr) {
+			return FF_FAIL;
+		}
+
+		PackedValues.assign(PackedParams.size(), 0.0f);
+		PackedChannels.resize(PackedParams.size());
+		for (size_t i = 0; i < PackedParams.size(); i++) {
+			PackedChannels[i] = &PackedValues[i];
+		}
+		PackedSent = false;
+	}
+
+	bool changed = !PackedSent;
+	for (size_t i = 0; i < PackedParams.size(); i++) {
+		float value = static_cast<float>(ParameterMapFloat[PackedParams[i]]);
+		if (value != PackedValues[i]) {
+			PackedValues[i] = value;
+			changed = true;
+		}
+	}
+
+	if (!changed) {
+		return FF_SUCCESS;
+	}
+
+	if (TEFloatBufferSetValues(PackedBuffer, PackedChannels.data(), 1) != TEResultSuccess) {
+		return FF_FAIL;
+	}
+
+	if (TEInstanceLinkSetFloatBufferValue(instance, PackedParamsLink.c_str(), PackedBuffer) != TEResultSuccess) {
+		return FF_FAIL;
+	}
+
+	PackedSent = true;
+	return FF_SUCCESS;
+}
+
+void FFGLTouchEnginePluginBase::RecordAutomation(FFUInt32 param, float value, int64_t timeNs) {
+	auto it = AutomationIndex.find(param);
+	if (it == AutomationIndex.end()) {
+		return;
+	}
+
+	AutomationChannel& channel = AutomationChannels[it->second];
+	if (channel.Count == AutomationChannel::MaxEvents) {
+		channel.First = (channel.First + 1) % AutomationChannel::MaxEvents;
+		channel.Count--;
+	}
+	channel.Events[(channel.First + channel.Count) % AutomationChannel::MaxEvents] = std::make_pair(timeNs, value);
+	channel.Count++;
+}
+
+FFResult FFGLTouchEnginePluginBase::PushAutomation(int64_t frameNs) {
+	if (AutomationLink.empty() || PackedParams.empty()) {
+		return FF_SUCCESS;
+	}
+
+	const uint32_t maxSamples = AutomationSamplesPerFrame * AutomationMaxFrames;
+	if (AutomationChannels.size() != PackedParams.size()) {
+		AutomationChannels.assign(PackedParams.size(), AutomationChannel());
+		AutomationIndex.clear();
+		for (uint32_t i = 0; i < PackedParams.size(); i++) {
+			AutomationIndex[PackedParams[i]] = i;
+			AutomationChannels[i].Held = static_cast<float>(ParameterMapFloat[PackedParams[i]]);
+		}
+		AutomationSamples.assign(PackedParams.size() * maxSamples, 0.0f);
+		AutomationPointers.resize(PackedParams.size());
+		AutomationNames.clear();
+		for (auto& name : PackedNames) {
+			AutomationNames.push_back(name.c_str());
+		}
+		LastAutomationNs = 0;
+
+		// Sized for the longest interval, each frame fills as many samples as it needs
+		AutomationBuffer.take(TEFloatBufferCreateTimeDependent(60.0 * AutomationSamplesPerFrame, static_cast<int32_t>(AutomationChannels.size()), maxSamples, AutomationNames.data()));
+		if (AutomationBuffer == nullptr) {
+			AutomationChannels.clear();
+			return FF_FAIL;
+		}
+	}
+
+	// The samples cover the TouchEngine time between the previous frame start and this one, host time is mapped linearly onto it
+	uint64_t frames = LastAutomationNs == 0 ? 1 : std::min<uint64_t>(std::max<uint64_t>(FrameCount - LastStartFrame, 1), AutomationMaxFrames);
+	uint32_t count = static_cast<uint32_t>(frames) * AutomationSamplesPerFrame;
+	int64_t intervalStart = LastAutomationNs == 0 ? frameNs : LastAutomationNs;
+	int64_t span = frameNs - intervalStart;
+
+	for (uint32_t c = 0; c < AutomationChannels.size(); c++) {
+		AutomationChannel& channel = AutomationChannels[c];
+		float* samples = &AutomationSamples[c * maxSamples];
+
+		for (uint32_t k = 0; k < count; k++) {
+			int64_t sampleNs = intervalStart + span * (k + 1) / count;
+			while (channel.Count > 0 && channel.Events[channel.First].first <= sampleNs) {
+				channel.Held = channel.Events[channel.First].second;
+				channel.First = (channel.First + 1) % AutomationChannel::MaxEvents;
+				channel.Count--;
+			}
+			samples[k] = channel.Held;
+		}
+		AutomationPointers[c] = samples;
+	}
+	LastAutomationNs = frameNs;
+
+	// The instance may retain the buffer, but only until the frame it was added for has finished, and
+	// a new frame is never started before that, so one buffer is refilled every frame
+	if (TEFloatBufferSetValues(AutomationBuffer, AutomationPointers.data(), count) != TEResultSuccess) {
+		return FF_FAIL;
+	}
+
+	// Same clock as TEInstanceStartFrameAtTime, FrameCount in 1/60 s steps. The last frame's worth of
+	// samples is stamped at the frame being started, so it cooks with them instead of one frame later,
+	// and each buffer starts where the previous one ended.
+	TEFloatBufferSetStartTime(AutomationBuffer, static_cast<int64_t>(FrameCount - frames + 1) * AutomationSamplesPerFrame);
+
+	if (TEInstanceLinkAddFloatBuffer(instance, AutomationLink.c_str(), AutomationBuffer) != TEResultSuccess) {
+		return FF_FAIL;
+	}
+
+	return FF_SUCCESS;
+}
+
+FFResult FFGLTouchEnginePluginBase::PushBeatInfo(int64_t frameNs) {
+	if ((BpmLink.empty() && BarPhaseLink.empty()) || BeatInfoNs == 0) {
+		return FF_SUCCESS;
+	}
+
+	if (!BpmLink.empty() && HostBpm != SentBpm) {
+		if (TEInstanceLinkSetDoubleValue(instance, BpmLink.c_str(), &HostBpm, 1) != TEResultSuccess) {
+			return FF_FAIL;
+		}
+		SentBpm = HostBpm;
+	}
+
+	if (!BarPhaseLink.empty()) {
+		// The host reports the phase of the frame it renders now. The TouchEngine frame started for FrameCount
+		// is first shown on the next host frame, and with Frame Blend only fully once the blend towards it has
+		// run for one TouchEngine step, so the phase is advanced to that host frame. FFGL has no time signature
+		// so a bar is four beats. A host that stopped reporting is not extrapolated.
+		double phase = HostBarPhase;
+		if (frameNs - BeatInfoNs < 100000000) {
+			uint64_t step = LastStartFrame == 0 ? 1 : std::max<uint64_t>(FrameCount - LastStartFrame, 1);
+			uint64_t latencyFrames = 1 + (FrameBlendEnabled ? step : 0);
+			phase += latencyFrames * HostFrameSeconds * HostBpm / 60.0 / 4.0;
+		}
+		phase -= std::floor(phase);
+		if (TEInstanceLinkSetDoubleValue(instance, BarPhaseLink.c_str(), &phase, 1) != TEResultSuccess) {
+			return FF_FAIL;
+		}
+	}
+
+	return FF_SUCCESS;
+}
+
+void FFGLTouchEnginePluginBase::SetBeatInfo(float bpm, float barPhase) {
+	CFFGLPlugin::SetBeatInfo(bpm, barPhase);
+
+	HostBpm = bpm;
+	HostBarPhase = barPhase;
+	BeatInfoNs = GetSteadyTimeNs();
+}
+
+void FFGLTouchEnginePluginBase::SetSampleRate(unsigned int rate) {
+	CFFGLPlugin::SetSampleRate(rate);
+
+	if (rate == 0 || rate == AudioSampleRate) {
+		return;
+	}
+
+	// The rate is fixed at creation, the next push recreates the buffer
+	AudioSampleRate = rate;
+	AudioFFTBuffer.reset();
+}
+
+float FFGLTouchEnginePluginBase::GetEffectiveRenderScale() const {
+	if (!AdaptiveQualityEnabled) {
+		return RenderScale;
+	}
+	return RenderScale * QualityController.GetRenderScale();
+}
+
+void FFGLTouchEnginePluginBase::BeginHostFrame() {
+	// FrameCount is the host frame clock, TouchEngine frames are started on a subset of it
+	FrameCount++;
+
+	ReleaseRetiredOutputs();
+	ApplyMorph();
+
+	int64_t now = GetSteadyTimeNs();
+	if (LastHostFrameNs != 0) {
+		// Clamped so a stall doesn't throw the tempo extrapolation far ahead
+		HostFrameSeconds = std::min(std::max((now - LastHostFrameNs) / 1000000000.0, 1.0 / 240.0), 0.1);
+	}
+	if (TickRate > 0.0f && LastHostFrameNs != 0) {
+		HostFrameStep = (now - LastHostFrameNs) / 1000000000.0 * TickRate;
+		// Don't owe more than one tick after a stall, TouchEngine would only burst to catch up
+		TickPhase = std::min(TickPhase + HostFrameStep, 1.0 + HostFrameStep);
+	}
+	LastHostFrameNs = now;
+
+	// External changes land before this frame's parameters are pushed
+	if (ExternalControlDirty.exchange(false)) {
+		UpdateExternalControl();
+	}
+	if (ExternalControl.IsOpen() && isTouchEngineReady) {
+		ExternalControl.Drain(now, [this](const char* identifier, double value, int64_t timeNs) {
+			ApplyExternalValue(identifier, value, timeNs);
+		});
+	}
+
+	if (!AdaptiveQualityEnabled) {
+		return;
+	}
+
+	int64_t costNs = LastFrameCostNs.exchange(0);
+	if (costNs > 0) {
+		QualityController.AddSample(costNs / 1000000.0);
+	}
+	QualityController.Update();
+}
+
+bool FFGLTouchEnginePluginBase::ShouldStartFrame() const {
+	uint64_t divisor = TickDivisor;
+	if (AdaptiveQualityEnabled) {
+		divisor *= QualityController.GetTickDivisor();
+	}
+	if (FrameCount - LastStartFrame < divisor) {
+		return false;
+	}
+
+	// Tick on the host frame nearest to when the next TouchEngine frame is due
+	if (TickRate > 0.0f) {
+		return TickPhase + HostFrameStep * 0.5 >= 1.0;
+	}
+
+	return true;
+}
+
+FFResult FFGLTouchEnginePluginBase::StartTouchFrame() {
+	int64_t startNs = GetSteadyTimeNs();
+	FrameStartNs = startNs;
+
+	// Sent here rather than with the other parameters so input uploads don't skew the phase
+	if (PushBeatInfo(startNs) != FF_SUCCESS) {
+		isTouchFrameBusy = false;
+		return FailAndLog("Failed to set beat info");
+	}
+
+	if (PushAutomation(startNs) != FF_SUCCESS) {
+		isTouchFrameBusy = false;
+		return FailAndLog("Failed to add automation samples");
+	}
+
+	TEResult result = TEInstanceStartFrameAtTime(instance, FrameCount, 60, false);
+	if (result != TEResultSuccess)
+	{
+		isTouchFrameBusy = false;
+		return FF_FAIL;
+	}
+
+	LastStartFrame = FrameCount;
+	TE_ACCOUNT_END_FRAME();
+	if (TickRate > 0.0f) {
+		TickPhase = std::max(TickPhase - 1.0, -0.5);
+	}
+	return FF_SUCCESS;
+}
+
+bool FFGLTouchEnginePluginBase::ConsumeNewTouchFrame() {
+	if (!hasNewTouchFrame.exchange(false)) {
+		return false;
+	}
+
+	NewFrameInterval = std::max<uint64_t>(1, FrameCount - LastNewFrame);
+	LastNewFrame = FrameCount;
+	return true;
+}
+
+// Rectangle textures are sampled in pixels, 2D textures in 0-1
+static void GetOutputScale(const TouchEngineOutput& output, uint32_t features, float& scaleU, float& scaleV) {
+	bool rect = (features & PresentationRectTexture) != 0;
+	scaleU = rect ? (float)output.Width : 1.0f;
+	scaleV = rect ? (float)output.Height : 1.0f;
+}
+
+void FFGLTouchEnginePluginBase::CapturePreviousFrame(const TouchEngineOutput& output) {
+	PreviousFrameSource = nullptr;
+
+	if (!FrameBlendEnabled || output.Texture == 0 || output.Width <= 0 || output.Height <= 0) {
+		return;
+	}
+
+	if (PreviousFrame.GetWidth() != (GLuint)output.Width || PreviousFrame.GetHeight() != (GLuint)output.Height) {
+		PreviousFrame.Release();
+		if (!PreviousFrame.Initialise(output.Width, output.Height)) {
+			return;
+		}
+	}
+
+	uint32_t features = GetOutputFeatures() & PresentationRectTexture;
+	float scaleU, scaleV;
+	GetOutputScale(output, features, scaleU, scaleV);
+
+	// Keep the source orientation and channel order, the blend pass applies them to both frames
+	ffglex::ScopedFBOBinding fboBinding(PreviousFrame.GetGLID(), ffglex::ScopedFBOBinding::RB_REVERT);
+	PreviousFrame.ResizeViewPort();
+	if (presentation.Draw(quad, output.Texture, features, scaleU, scaleV)) {
+		PreviousFrameSource = &output;
+	}
+	glViewport(currentViewport.x, currentViewport.y, currentViewport.width, currentViewport.height);
+}
+
+void FFGLTouchEnginePluginBase::PresentOutput(const TouchEngineOutput& output) {
+	uint32_t features = GetOutputFeatures(output);
+	float blendFactor = 1.0f;
+
+	float scaleU, scaleV;
+	GetOutputScale(output, features, scaleU, scaleV);
+
+	if (FrameBlendEnabled && PreviousFrameSource == &output && NewFrameInterval > 1) {
+		// Shows the previous frame when a new one lands and reaches it just before the next
+		blendFactor = std::min(1.0f, static_cast<float>(FrameCount - LastNewFrame) / NewFrameInterval);
+		if (blendFactor < 1.0f) {
+			features |= PresentationBlendPrevious;
+		}
+	}
+
+	presentation.Draw(quad, output.Texture, features, scaleU, scaleV, PreviousFrame.GetTextureInfo().Handle, blendFactor);
+}
+
+void FFGLTouchEnginePluginBase::ReleaseFrameHistory() {
+	PreviousFrame.Release();
+	PreviousFrameSource = nullptr;
+}
+
+void FFGLTouchEnginePluginBase::RegisterOutput(const TouchObject<TELinkInfo>& linkInfo) {
+	auto output = std::make_shared<TouchEngineOutput>();
+	output->Identifier = linkInfo->identifier;
+	output->Name = linkInfo->name;
+
+	std::lock_guard<std::mutex> lock(OutputsMutex);
+	if (PrimaryOutput == nullptr || strcmp(linkInfo->name, "out1") == 0) {
+		PrimaryOutput = output;
+	}
+	Outputs.push_back(output);
+	hasVideoOutput = true;
+}
+
+void FFGLTouchEnginePluginBase::RegisterChannelOutput(const TouchObject<TELinkInfo>& linkInfo) {
+	ChannelOutput output;
+	output.Identifier = linkInfo->identifier;
+	output.Name = linkInfo->name;
+
+	// Slots are assigned once the channel layout is known, from the first value
+	std::lock_guard<std::mutex> lock(OutputsMutex);
+	ChannelOutputs.push_back(std::move(output));
+}
+
+void FFGLTouchEnginePluginBase::AssignChannelSlots(ChannelOutput& output, const TEFloatBuffer* buffer) {
+	uint32_t channels = static_cast<uint32_t>(std::max(0, TEFloatBufferGetChannelCount(buffer)));
+	uint32_t available = MaxParamsByType - OutputParamCount;
+	if (channels > available) {
+		FFGLLog::LogToHost(("Too many CHOP output channels, " + output.Name + " is truncated").c_str());
+		channels = available;
+	}
+
+	const char* const* names = TEFloatBufferGetChannelNames(buffer);
+	output.FirstSlot = OutputParamCount;
+	output.Channels = channels;
+	output.Assigned = true;
+	output.Min.assign(channels, 0.0f);
+	output.Max.assign(channels, 1.0f);
+	OutputParamCount += channels;
+
+	for (uint32_t i = 0; i < channels; i++) {
+		uint32_t ParamID = OutputParamsOffset + output.FirstSlot + i;
+		std::string channel = names != nullptr && names[i] != nullptr ? names[i] : std::to_string(i);
+		SetParamDisplayName(ParamID, output.Name + ":" + channel, true);
+		SetParamVisibility(ParamID, true, true);
+	}
+}
+
+void FFGLTouchEnginePluginBase::ReadChannelOutputs() {
+	// Registration runs on a TouchEngine thread, skip a frame rather than wait on it
+	std::unique_lock<std::mutex> lock(OutputsMutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		return;
+	}
+
+	for (auto& output : ChannelOutputs) {
+		TouchObject<TEFloatBuffer> buffer;
+		if (TEInstanceLinkGetFloatBufferValue(instance, output.Identifier.c_str(), TELinkValueCurrent, buffer.take()) != TEResultSuccess || buffer == nullptr) {
+			continue;
+		}
+
+		// The layout is fixed by the first value, channels added later are not shown
+		if (!output.Assigned) {
+			AssignChannelSlots(output, buffer);
+		}
+
+		const float* const* values = TEFloatBufferGetValues(buffer);
+		uint32_t count = TEFloatBufferGetValueCount(buffer);
+		uint32_t channels = std::min(output.Channels, static_cast<uint32_t>(std::max(0, TEFloatBufferGetChannelCount(buffer))));
+		if (values == nullptr || count == 0) {
+			continue;
+		}
+
+		// A time sliced CHOP carries several samples per frame, the newest one is shown. Hosts read
+		// standard parameters as 0..1, so each channel is normalised over the range it has covered,
+		// which stays 0..1 for channels that never leave it.
+		for (uint32_t i = 0; i < channels; i++) {
+			float sample = values[i][count - 1];
+			if (!std::isfinite(sample)) {
+				continue;
+			}
+			output.Min[i] = std::min(output.Min[i], sample);
+			output.Max[i] = std::max(output.Max[i], sample);
+			float value = (sample - output.Min[i]) / (output.Max[i] - output.Min[i]);
+			uint32_t slot = output.FirstSlot + i;
+			if (value != OutputParamValues[slot]) {
+				OutputParamValues[slot] = value;
+				RaiseParamEvent(OutputParamsOffset + slot, FF_EVENT_FLAG_VALUE);
+			}
+		}
+	}
+}
+
+std::string FFGLTouchEnginePluginBase::GetInstanceName() const {
+	if (!InstanceName.empty()) {
+		return InstanceName;
+	}
+	return DefaultInstanceName;
+}
+
+void FFGLTouchEnginePluginBase::ClaimDefaultInstanceName() {
+	if (!DefaultInstanceName.empty()) {
+		OutputRegistry::Get().ReleaseName(DefaultInstanceName);
+		DefaultInstanceName.clear();
+	}
+
+	size_t start = FilePath.find_last_of("/\\");
+	std::string name = start == std::string::npos ? FilePath : FilePath.substr(start + 1);
+	name = name.substr(0, name.find_last_of('.'));
+	if (!name.empty()) {
+		DefaultInstanceName = OutputRegistry::Get().ClaimName(name);
+	}
+}
+
+void FFGLTouchEnginePluginBase::PublishOutputs() {
+	std::lock_guard<std::mutex> lock(OutputsMutex);
+
+	for (auto& output : Outputs) {
+		OutputRegistry::Get().Withdraw(PublishedName + "/" + output->Name, output.get());
+	}
+
+	PublishedName = GetInstanceName();
+	for (auto& output : Outputs) {
+		OutputRegistry::Get().Publish(PublishedName + "/" + output->Name, output);
+	}
+}
+
+void FFGLTouchEnginePluginBase::RetireOutputs() {
+	std::lock_guard<std::mutex> lock(OutputsMutex);
+
+	for (auto& output : Outputs) {
+		OutputRegistry::Get().Withdraw(PublishedName + "/" + output->Name, output.get());
+		RetiredOutputs.push_back(output);
+	}
+	Outputs.clear();
+	PrimaryOutput.reset();
+}
+
+void FFGLTouchEnginePluginBase::ReleaseRetiredOutputs() {
+	std::vector<std::shared_ptr<TouchEngineOutput>> retired;
+	{
+		std::lock_guard<std::mutex> lock(OutputsMutex);
+		retired.swap(RetiredOutputs);
+	}
+
+	for (auto& output : retired) {
+		if (PreviousFrameSource == output.get()) {
+			PreviousFrameSource = nullptr;
+		}
+	}
+	// Outputs other instances still present are freed when they let go of them
+	retired.clear();
+}
+
+void FFGLTouchEnginePluginBase::ReleaseOutputs() {
+	RetireOutputs();
+	ReleaseRetiredOutputs();
+
+	if (PresentedOutput != nullptr) {
+		PresentedOutput->Subscribers--;
+		PresentedOutput.reset();
+	}
+	PresentedKey.clear();
+}
+
+TouchEngineOutput::~TouchEngineOutput() {
+	// The last reference is dropped on the host's render thread, by the owner or a subscriber
+	ReleaseResources();
+}
+
+void TouchEngineOutput::ReleaseResources() {
+	Interop.reset();
+	if (Texture != 0) {
+		glDeleteTextures(1, &Texture);
+		Texture = 0;
+	}
+}
+
+TouchEngineOutput* FFGLTouchEnginePluginBase::ResolvePresentedOutput() {
+	std::shared_ptr<TouchEngineOutput> target;
+
+	if (OutputSelect.empty()) {
+		std::lock_guard<std::mutex> lock(OutputsMutex);
+		target = PrimaryOutput;
+	} else if (OutputSelect.find('/') == std::string::npos) {
+		std::lock_guard<std::mutex> lock(OutputsMutex);
+		for (auto& output : Outputs) {
+			if (output->Name == OutputSelect) {
+				target = output;
+				break;
+			}
+		}
+	} else {
+		target = OutputRegistry::Get().Find(OutputSelect);
+	}
+
+	if (target == nullptr && !OutputSelect.empty() && PresentedKey != OutputSelect) {
+		std::string available;
+		for (auto& key : OutputRegistry::Get().GetKeys()) {
+			available += " " + key;
+		}
+		FFGLLog::LogToHost(("TouchEngine output " + OutputSelect + " not found, available:" + available).c_str());
+	}
+	PresentedKey = OutputSelect;
+
+	// The owner only fetches outputs somebody presents
+	if (target != PresentedOutput) {
+		if (PresentedOutput != nullptr) {
+			PresentedOutput->Subscribers--;
+		}
+		if (target != nullptr) {
+			target->Subscribers++;
+		}
+		PresentedOutput = target;
+	}
+
+	return PresentedOutput.get();
+}
+
+bool FFGLTouchEnginePluginBase::PresentLastOutput() {
+	TouchEngineOutput* presented = ResolvePresentedOutput();
+	if (presented == nullptr) {
+		return false;
+	}
+
+	PresentOutput(*presented);
+	return true;
+}
+
+FFResult FFGLTouchEnginePluginBase::UpdateOutputs(bool newFrame, GLuint hostFBO) {
+	TouchEngineOutput* presented = ResolvePresentedOutput();
+
+	if (newFrame) {
+		ReadChannelOutputs();
+		ReadTableOutputs();
+
+		std::vector<std::shared_ptr<TouchEngineOutput>> outputs;
+		{
+			std::lock_guard<std::mutex> lock(OutputsMutex);
+			outputs = Outputs;
+		}
+
+		for (auto& output : outputs) {
+			if (output->Subscribers == 0) {
+				continue;
+			}
+
+			if (output.get() == presented) {
+				CapturePreviousFrame(*output);
+			}
+
+			FFResult result = Graphics->FetchOutput(instance, *output, hostFBO);
+			if (result != FF_SUCCESS) {
+				return result;
+			}
+		}
+	}
+
+	if (presented != nullptr) {
+		PresentOutput(*presented);
+	}
+
+	return FF_SUCCESS;
+}
+
+FFUInt32 FFGLTouchEnginePluginBase::AllocateParameter(ParamBlock block, uint32_t count) {
+	uint32_t next = BlockCounts[block];
+
+	// A color group never straddles two pages
+	if (next % MaxParamsByType + count > MaxParamsByType) {
+		next = (next / MaxParamsByType + 1) * MaxParamsByType;
+	}
+	BlockCounts[block] = next + count;
+
+	uint32_t page = next / MaxParamsByType;
+	PageCount = std::max(PageCount, page + 1);
+	return page * PageStride + OffsetParamsByType + block * MaxParamsByType + next % MaxParamsByType;
+}
+
+void FFGLTouchEnginePluginBase::ExposeParameter(FFUInt32 ParamID, const std::string& label) {
+	ParameterLayout layout;
+	layout.Label = label;
+	ExposeParameter(ParamID, std::move(layout));
+}
+
+void FFGLTouchEnginePluginBase::ExposeParameter(FFUInt32 ParamID, const std::string& label, float min, float max) {
+	ParameterLayout layout;
+	layout.Label = label;
+	layout.HasRange = true;
+	layout.Min = min;
+	layout.Max = max;
+	ExposeParameter(ParamID, std::move(layout));
+}
+
+void FFGLTouchEnginePluginBase::ExposeParameter(FFUInt32 ParamID, const std::string& label, const std::vector<std::string>& elements, const std::vector<float>& values) {
+	ParameterLayout layout;
+	layout.Label = label;
+	layout.Elements = elements;
+	layout.ElementValues = values;
+	ExposeParameter(ParamID, std::move(layout));
+}
+
+void FFGLTouchEnginePluginBase::ExposeParameter(FFUInt32 ParamID, ParameterLayout layout) {
+	if (IsOnPage(ParamID)) {
+		ApplyParameterLayout(ParamID % PageStride, layout);
+	}
+	ParameterLayouts[ParamID] = std::move(layout);
+}
+
+void FFGLTouchEnginePluginBase::ApplyParameterLayout(FFUInt32 slot, const ParameterLayout& layout) {
+	if (!layout.Elements.empty()) {
+		SetParamElements(slot, layout.Elements, layout.ElementValues, true);
+	}
+	if (layout.HasRange) {
+		SetParamRange(slot, layout.Min, layout.Max);
+	}
+	SetParamDisplayName(slot, layout.Label, true);
+	RaiseParamEvent(slot, FF_EVENT_FLAG_VALUE);
+	SetParamVisibility(slot, true, true);
+}
+
+void FFGLTouchEnginePluginBase::RaiseParameterValue(FFUInt32 ParamID) {
+	if (IsOnPage(ParamID)) {
+		RaiseParamEvent(ParamID % PageStride, FF_EVENT_FLAG_VALUE);
+	}
+}
+
+void FFGLTouchEnginePluginBase::ShowPage(uint32_t page) {
+	if (page == ParameterPage) {
+		return;
+	}
+
+	// Only the slots change, values of every page stay in the parameter maps and keep being pushed
+	uint32_t previous = ParameterPage;
+	ParameterPage = page;
+	for (FFUInt32 slot = OffsetParamsByType; slot < OutputParamsOffset; slot++) {
+		auto layout = ParameterLayouts.find(page * PageStride + slot);
+		if (layout != ParameterLayouts.end()) {
+			ApplyParameterLayout(slot, layout->second);
+		} else if (ParameterLayouts.find(previous * PageStride + slot) != ParameterLayouts.end()) {
+			SetParamVisibility(slot, false, true);
+		}
+	}
+}
+
+void FFGLTouchEnginePluginBase::UpdatePageControl() {
+	std::vector<std::string> labels;
+	std::vector<float> values;
+	for (uint32_t i = 0; i < PageCount; i++) {
+		labels.push_back(std::to_string(i + 1));
+		values.push_back(static_cast<float>(i));
+	}
+	SetParamElements(ControlParamsOffset + ControlPage, labels, values, true);
+}
+
+// Banks live in the user's data directory, keyed by tox path, empty when there is none
+static std::string GetSnapshotPath(const std::string& toxPath) {
+	std::string directory = GetUserDataDirectory();
+	if (directory.empty()) {
+		return "";
+	}
+	return (std::filesystem::path(directory) / (GetPathKey(toxPath) + ".snapshots")).string();
+}
+
+void FFGLTouchEnginePluginBase::CaptureSnapshot(uint32_t slot) {
+	ParameterSnapshot& snapshot = Snapshots[slot];
+	snapshot.Clear();
+
+	for (auto& param : Parameters) {
+		FFUInt32 type = ParameterMapType[param.second];
+		switch (type) {
+		case FF_TYPE_EVENT:
+			// Pulses and momentary buttons are actions, not state
+			break;
+		case FF_TYPE_INTEGER:
+		case FF_TYPE_OPTION:
+			snapshot.WriteNumber(param.first, ParameterSnapshot::ValueInt, ParameterMapInt[param.second]);
+			break;
+		case FF_TYPE_BOOLEAN:
+			snapshot.WriteNumber(param.first, ParameterSnapshot::ValueBool, ParameterMapBool[param.second] ? 1.0 : 0.0);
+			break;
+		case FF_TYPE_TEXT:
+			snapshot.WriteText(param.first, ParameterMapString[param.second]);
+			break;
+		default:
+			snapshot.WriteNumber(param.first, ParameterSnapshot::ValueFloat, ParameterMapFloat[param.second]);
+			break;
+		}
+	}
+
+	for (auto& input : TableInputs) {
+		snapshot.WriteText(input.Identifier, ParameterMapString[input.ParamID]);
+	}
+
+	MorphTableValid = false;
+
+	if (FilePath.empty()) {
+		return;
+	}
+	std::string path = GetSnapshotPath(FilePath);
+	if (path.empty()) {
+		FFGLLog::LogToHost("Failed to save snapshots");
+		return;
+	}
+	// Written on the writer's thread, storing a snapshot must not stall the frame on disk I/O
+	SnapshotWriter->Queue(path, Snapshots);
+}
+
+void FFGLTouchEnginePluginBase::RecallSnapshot(uint32_t slot) {
+	if (Snapshots[slot].IsEmpty()) {
+		FFGLLog::LogToHost(("Snapshot " + std::to_string(slot + 1) + " is empty").c_str());
+		return;
+	}
+
+	std::unordered_map<std::string, FFUInt32> ids;
+	for (auto& param : Parameters) {
+		ids[param.first] = param.second;
+	}
+	for (auto& input : TableInputs) {
+		ids[input.Identifier] = input.ParamID;
+	}
+
+	// Values are matched by identifier, so a snapshot survives parameters being added to the tox
+	Snapshots[slot].Read([&](const std::string& identifier, const ParameterSnapshot::Value& value) {
+		auto id = ids.find(identifier);
+		if (id == ids.end()) {
+			return;
+		}
+		FFUInt32 ParamID = id->second;
+
+		switch (value.Type) {
+		case ParameterSnapshot::ValueFloat: {
+			auto it = ParameterMapFloat.find(ParamID);
+			if (it == ParameterMapFloat.end()) {
+				return;
+			}
+			it->second = value.Number;
+			break;
+		}
+		case ParameterSnapshot::ValueInt: {
+			auto it = ParameterMapInt.find(ParamID);
+			if (it == ParameterMapInt.end()) {
+				return;
+			}
+			it->second = static_cast<int32_t>(value.Number);
+			break;
+		}
+		case ParameterSnapshot::ValueBool: {
+			auto it = ParameterMapBool.find(ParamID);
+			if (it == ParameterMapBool.end()) {
+				return;
+			}
+			it->second = value.Number != 0.0;
+			break;
+		}
+		case ParameterSnapshot::ValueText: {
+			auto it = ParameterMapString.find(ParamID);
+			if (it == ParameterMapString.end()) {
+				return;
+			}
+			it->second = value.Text;
+			break;
+		}
+		}
+
+		RaiseParameterValue(ParamID);
+	});
+}
+
+void FFGLTouchEnginePluginBase::BuildMorphTable() {
+	MorphParams.clear();
+	MorphIsInt.clear();
+	MorphFrom.clear();
+
+	std::unordered_map<std::string, size_t> rows;
+	for (auto& param : Parameters) {
+		FFUInt32 type = ParameterMapType[param.second];
+		bool isInt = type == FF_TYPE_INTEGER || type == FF_TYPE_OPTION;
+		if (!isInt && ParameterMapFloat.find(param.second) == ParameterMapFloat.end()) {
+			continue;
+		}
+
+		rows[param.first] = MorphParams.size();
+		MorphParams.push_back(param.second);
+		MorphIsInt.push_back(isInt ? 1 : 0);
+		MorphFrom.push_back(isInt ? ParameterMapInt[param.second] : ParameterMapFloat[param.second]);
+	}
+
+	// Parameters missing from a snapshot hold their current value across the morph
+	MorphTo = MorphFrom;
+	MorphValues.resize(MorphFrom.size());
+
+	auto fill = [&](const ParameterSnapshot& snapshot, std::vector<double>& column) {
+		snapshot.Read([&](const std::string& identifier, const ParameterSnapshot::Value& value) {
+			auto row = rows.find(identifier);
+			if (row != rows.end() && (value.Type == ParameterSnapshot::ValueFloat || value.Type == ParameterSnapshot::ValueInt)) {
+				column[row->second] = value.Number;
+			}
+		});
+	};
+	fill(Snapshots[SnapshotSlot], MorphFrom);
+	fill(Snapshots[MorphTarget], MorphTo);
+
+	MorphTableValid = true;
+}
+
+void FFGLTouchEnginePluginBase::ApplyMorph() {
+	if (!MorphDirty) {
+		return;
+	}
+	MorphDirty = false;
+
+	if (Snapshots[SnapshotSlot].IsEmpty() || Snapshots[MorphTarget].IsEmpty()) {
+		return;
+	}
+
+	if (!MorphTableValid) {
+		BuildMorphTable();
+	}
+
+	// Branch-free over contiguous columns so the compiler vectorizes it
+	const size_t count = MorphValues.size();
+	const double amount = MorphAmount;
+	const double* from = MorphFrom.data();
+	const double* to = MorphTo.data();
+	double* values = MorphValues.data();
+	for (size_t i = 0; i < count; i++) {
+		values[i] = from[i] + (to[i] - from[i]) * amount;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		FFUInt32 ParamID = MorphParams[i];
+		if (MorphIsInt[i]) {
+			ParameterMapInt[ParamID] = static_cast<int32_t>(std::lround(values[i]));
+		} else {
+			ParameterMapFloat[ParamID] = values[i];
+		}
+		RaiseParameterValue(ParamID);
+	}
+}
+
+void FFGLTouchEnginePluginBase::LoadSnapshots() {
+	for (auto& snapshot : Snapshots) {
+		snapshot.Clear();
+	}
+	MorphTableValid = false;
+
+	if (FilePath.empty()) {
+		return;
+	}
+	// Banks used to be saved next to the tox, those are still read until the first store
+	std::string path = GetSnapshotPath(FilePath);
+	if (path.empty() || (!SnapshotWriter->FindQueued(path, Snapshots) && !LoadSnapshotBank(path, Snapshots))) {
+		LoadSnapshotBank(FilePath + ".snapshots", Snapshots);
+	}
+}
+
+void FFGLTouchEnginePluginBase::ExposeSchema(const ToxSchema& schema) {
+	ResetBaseParameters();
+
+	// Allocates slots in the same order and blocks as GetAllParameters, so they don't move once TouchEngine has loaded
+	for (auto& link : schema.Links) {
+		// DAT parameters, DAT Ins and DAT Outs are all text parameters
+		if (link.Type == TELinkTypeStringData && (link.Scope == TEScopeInput || link.Domain == TELinkDomainOperator)) {
+			ExposeParameter(AllocateParameter(ParamBlockText), link.Label);
+			continue;
+		}
+
+		if (link.Scope != TEScopeInput || link.Domain != TELinkDomainParameter) {
+			continue;
+		}
+
+		// Reserved parameters, see HandleReservedLink
+		if ((link.Type == TELinkTypeDouble && link.Count == 1 && (link.Name == "Bpm" || link.Name == "Barphase")) ||
+			(link.Type == TELinkTypeInt && (link.Name == "Renderwidth" || link.Name == "Renderheight"))) {
+			continue;
+		}
+
+		// Slots are allocated whether or not the schema holds a range, like CreateIndividualParameter
+		// does, the range then stays at the default until TouchEngine has loaded
+		auto getMin = [&link](size_t i) { return i < link.Min.size() ? static_cast<float>(link.Min[i]) : 0.0f; };
+		auto getMax = [&link](size_t i) { return i < link.Max.size() ? static_cast<float>(link.Max[i]) : 1.0f; };
+
+		switch (link.Type) {
+		case TELinkTypeDouble:
+		{
+			if (link.Intent == TELinkIntentColorRGBA || link.Intent == TELinkIntentPositionXYZW || link.Intent == TELinkIntentSizeWH) {
+				const char* suffix = link.Intent == TELinkIntentColorRGBA ? "RGBA" : link.Intent == TELinkIntentPositionXYZW ? "XYZW" : "WH";
+				FFUInt32 colorBase = link.Intent == TELinkIntentColorRGBA ? AllocateParameter(ParamBlockColor, 4) : 0;
+
+				for (int32_t i = 0; i < link.Count; i++) {
+					FFUInt32 ParamID = link.Intent == TELinkIntentColorRGBA && i < 4 ? colorBase + i : AllocateParameter(ParamBlockFloat);
+					ExposeParameter(ParamID, link.Label + std::string(".") + suffix[i], getMin(i), getMax(i));
+				}
+				break;
+			}
+
+			ExposeParameter(AllocateParameter(ParamBlockFloat), link.Label, getMin(0), getMax(0));
+			break;
+		}
+		case TELinkTypeInt:
+		{
+			if (!link.Choices.empty()) {
+				std::vector<float> values;
+				for (size_t i = 0; i < link.Choices.size(); i++) {
+					values.push_back(static_cast<float>(i));
+				}
+				ExposeParameter(AllocateParameter(ParamBlockOption), link.Label, link.Choices, values);
+			} else {
+				ExposeParameter(AllocateParameter(ParamBlockInt), link.Label, getMin(0), getMax(0));
+			}
+			break;
+		}
+		case TELinkTypeBoolean:
+		{
+			bool isPulse = link.Intent == TELinkIntentMomentary || link.Intent == TELinkIntentPulse;
+			ExposeParameter(AllocateParameter(isPulse ? ParamBlockPulse : ParamBlockBool), link.Label);
+			break;
+		}
+		case TELinkTypeString:
+		{
+			ExposeParameter(AllocateParameter(ParamBlockText), link.Label);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	UpdatePageControl();
+}
+
+void FFGLTouchEnginePluginBase::UpdateExternalControl() {
+	ExternalControlIDs.clear();
+	for (auto& param : Parameters) {
+		ExternalControlIDs[param.first] = param.second;
+	}
+
+	std::string name = ExternalControlEnabled && !FilePath.empty() ? GetInstanceName() : "";
+	if (name == ExternalControl.GetName()) {
+		return;
+	}
+
+	ExternalControl.Close();
+	if (!name.empty() && !ExternalControl.Open(name)) {
+		FFGLLog::LogToHost(("Failed to open external control channel " + name).c_str());
+	}
+}
+
+void FFGLTouchEnginePluginBase::ApplyExternalValue(const char* identifier, double value, int64_t timeNs) {
+	ExternalIdentifier.assign(identifier);
+	auto id = ExternalControlIDs.find(ExternalIdentifier);
+	if (id == ExternalControlIDs.end()) {
+		return;
+	}
+	FFUInt32 ParamID = id->second;
+
+	switch (ParameterMapType[ParamID]) {
+	case FF_TYPE_INTEGER:
+	case FF_TYPE_OPTION:
+		ParameterMapInt[ParamID] = static_cast<int32_t>(value);
+		break;
+	case FF_TYPE_BOOLEAN:
+	case FF_TYPE_EVENT: {
+		auto pulse = PulseQueues.find(ParamID);
+		if (pulse != PulseQueues.end() && value > 0.5 && !ParameterMapBool[ParamID]) {
+			if (!pulse->second->Push(timeNs)) {
+				FFGLLog::LogToHost("Pulse queue full, dropping a pulse");
+			}
+		}
+		ParameterMapBool[ParamID] = value > 0.5;
+		break;
+	}
+	case FF_TYPE_TEXT:
+		return;
+	default:
+		ParameterMapFloat[ParamID] = value;
+		if (!AutomationLink.empty()) {
+			RecordAutomation(ParamID, static_cast<float>(value), timeNs);
+		}
+		break;
+	}
+
+	RaiseParameterValue(ParamID);
+}
+
+void FFGLTouchEnginePluginBase::CreateTableParameter(const TouchObject<TELinkInfo>& linkInfo) {
+	uint32_t ParamID = AllocateParameter(ParamBlockText);
+	ActiveParams.insert(ParamID);
+	ParameterMapType[ParamID] = FF_TYPE_TEXT;
+
+	TableLink input;
+	input.Identifier = linkInfo->identifier;
+	input.ParamID = ParamID;
+
+	// Start from the tox's own content so the first edit is diffed against it
+	TouchObject<TETable> current;
+	if (TEInstanceLinkGetTableValue(instance, linkInfo->identifier, TELinkValueCurrent, current.take()) == TEResultSuccess && current != nullptr) {
+		input.Table.take(TETableCreateCopy(current));
+		input.Source = FormatTableText(current);
+	}
+
+	ParameterMapString[ParamID] = input.Source;
+	ExposeParameter(ParamID, linkInfo->label);
+
+	TableInputs.push_back(std::move(input));
+}
+
+void FFGLTouchEnginePluginBase::RegisterTableOutput(const TouchObject<TELinkInfo>& linkInfo) {
+	uint32_t ParamID = AllocateParameter(ParamBlockText);
+	ActiveParams.insert(ParamID);
+	ParameterMapType[ParamID] = FF_TYPE_TEXT;
+	ParameterMapString[ParamID] = "";
+	ExposeParameter(ParamID, linkInfo->label);
+
+	TableLink output;
+	output.Identifier = linkInfo->identifier;
+	output.ParamID = ParamID;
+
+	std::lock_guard<std::mutex> lock(OutputsMutex);
+	TableOutputs.push_back(std::move(output));
+}
+
+// A single line naming a readable file loads that file, anything else is table text
+static std::string LoadTableSource(const std::string& text) {
+	if (text.empty() || text.find('\n') != std::string::npos) {
+		return text;
+	}
+
+	std::ifstream file(text, std::ios::binary);
+	if (!file.is_open()) {
+		return text;
+	}
+
+	std::stringstream content;
+	content << file.rdbuf();
+	return content.str();
+}
+
+FFResult FFGLTouchEnginePluginBase::PushTableInputs() {
+	for (auto& input : TableInputs) {
+		const std::string& text = ParameterMapString[input.ParamID];
+		if (text == input.Source) {
+			continue;
+		}
+		input.Source = text;
+
+		bool created = false;
+		if (input.Table == nullptr) {
+			input.Table.take(TETableCreate());
+			created = true;
+		}
+
+		if (!ApplyTableRows(input.Table, ParseTableText(LoadTableSource(text))) && !created) {
+			continue;
+		}
+
+		if (TEInstanceLinkSetTableValue(instance, input.Identifier.c_str(), input.Table) != TEResultSuccess) {
+			return FF_FAIL;
+		}
+	}
+
+	return FF_SUCCESS;
+}
+
+void FFGLTouchEnginePluginBase::ReadTableOutputs() {
+	std::unique_lock<std::mutex> lock(OutputsMutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		return;
+	}
+
+	for (auto& output : TableOutputs) {
+		TouchObject<TETable> table;
+		if (TEInstanceLinkGetTableValue(instance, output.Identifier.c_str(), TELinkValueCurrent, table.take()) != TEResultSuccess) {
+			continue;
+		}
+
+		if (TablesEqual(output.Table, table)) {
+			continue;
+		}
+
+		// Keep a copy, the instance may reuse its table for the next frame
+		if (table != nullptr) {
+			output.Table.take(TETableCreateCopy(table));
+		} else {
+			output.Table.reset();
+		}
+
+		ParameterMapString[output.ParamID] = FormatTableText(table);
+		RaiseParameterValue(output.ParamID);
+	}
+}
+
+void FFGLTouchEnginePluginBase::CreateParametersFromGroup(const TouchObject<TELinkInfo>& linkInfo) {
+
+	TouchObject<TEStringArray> links;
+	TEResult result = TEInstanceLinkGetChildren(instance, linkInfo->identifier, links.take());
+
+	if (result != TEResultSuccess) {
+		return;
+	}
+
+	for (int j = 0; j < links->count; j++) {
+		TouchObject<TELinkInfo> linkInfo;
+		result = TEInstanceLinkGetInfo(instance, links->strings[j], linkInfo.take());
+
+		if (result != TEResultSuccess) {
+			continue;
+			FFGLLog::LogToHost("Failed to get link info");
+
+		}
+
+		CreateIndividualParameter(linkInfo);
+	}
+
+
+
+}
+
+FFResult FFGLTouchEnginePluginBase::PushParametersToTouchEngine()
+{
+	if (instance == nullptr) {
+		return FF_SUCCESS;
+	}
+
+	// Pulses pressed while this frame is being submitted belong to the next one
+	int64_t submitNs = GetSteadyTimeNs();
+
+	if (PushRenderResolution() != FF_SUCCESS) {
+		isTouchFrameBusy = false;
+		return FailAndLog("Failed to set render resolution");
+	}
+
+	if (PushAudioFFT() != FF_SUCCESS) {
+		isTouchFrameBusy = false;
+		return FailAndLog("Failed to set audio FFT");
+	}
+
+	if (PushTableInputs() != FF_SUCCESS) {
+		isTouchFrameBusy = false;
+		return FailAndLog("Failed to set table value");
+	}
+
+	if (PushPackedParameters() != FF_SUCCESS) {
+		isTouchFrameBusy = false;
+		return FailAndLog("Failed to set packed parameters");
+	}
+
+	for (auto& param : Parameters) {
+		FFUInt32 type = ParameterMapType[param.second];
+
+		if (ActiveVectorParams.find(param.second) != ActiveVectorParams.end()) {
+			continue;
+		}
+
+		if (type == FF_TYPE_STANDARD && !PackedParamsLink.empty()) {
+			continue;
+		}
+
+		if (type == FF_TYPE_STANDARD) {
+			TEResult result = TEInstanceLinkSetDoubleValue(instance, param.first.c_str(), &ParameterMapFloat[param.second], 1);
+			if (result != TEResultSuccess) {
+				isTouchFrameBusy = false;
+				return FailAndLog("Failed to set double value");
+			}
+		}
+
+		if (type == FF_TYPE_INTEGER || type == FF_TYPE_OPTION) {
+			TEResult result = TEInstanceLinkSetIntValue(instance, param.first.c_str(), &ParameterMapInt[param.second], 1);
+			if (result != TEResultSuccess) {
+				isTouchFrameBusy = false;
+				return FailAndLog("Failed to set int value");
+			}
+		}
+
+
+		if (type == FF_TYPE_BOOLEAN || type == FF_TYPE_EVENT) {
+			bool value = ParameterMapBool[param.second];
+
+			// One press queued up to this submission fires the pulse, the rest follow on the next frames.
+			// Without Pulse Spread every queued press is merged into this one pulse.
+			auto pulse = PulseQueues.find(param.second);
+			if (pulse != PulseQueues.end()) {
+				value = PulseSpreadEnabled ? pulse->second->Pop(submitNs) : pulse->second->Drain(submitNs) > 0;
+			}
+
+			TEResult result = TEInstanceLinkSetBooleanValue(instance, param.first.c_str(), value);
+			if (result != TEResultSuccess) {
+				isTouchFrameBusy = false;
+				return FailAndLog("Failed to set boolean value");
+			}
+		}
+
+		if (type == FF_TYPE_TEXT) {
+			TEResult result = TEInstanceLinkSetStringValue(instance, param.first.c_str(), ParameterMapString[param.second].c_str());
+			if (result != TEResultSuccess) {
+				isTouchFrameBusy = false;
+				return FailAndLog("Failed to set string value");
+			}
+		}
+
+	}
+
+	for (auto& param : VectorParameters) {
+		double values[4] = { 0,0,0,0 };
+
+		for (uint8_t i = 0; i < param.count; i++) {
+			values[i] = ParameterMapFloat[param.children[i]];
+		}
+
+		TEResult result = TEInstanceLinkSetDoubleValue(instance, param.identifier.c_str(), values, param.count);
+		if (result != TEResultSuccess) {
+			isTouchFrameBusy = false;
 			return FailAndLog("Failed to set int value");
 		}
 
@@ -974,6 +2478,11 @@ void FFGLTouchEnginePluginBase::eventCallback(TEEvent event, TEResult result, in
 	switch (event) {
 	case TEEventInstanceDidLoad:
 		if (LoadTEGraphicsContext(false)) {
+			// Associating a graphics context resets the output origin, so ask for the host's orientation
+			// once the context is in place, on every load, so neither side has to flip
+			if (TEInstanceSetOutputTextureOrigin(instance, GetHostTextureOrigin()) != TEResultSuccess) {
+				FFGLLog::LogToHost("Failed to set output texture origin, output will be flipped while drawing");
+			}
 			isTouchEngineLoaded = true;
 			ResumeTouchEngine();
 		} else {
@@ -981,6 +2490,14 @@ void FFGLTouchEnginePluginBase::eventCallback(TEEvent event, TEResult result, in
 		}
 		break;
 	case TEEventFrameDidFinish:
+		// A cancelled or failed frame has no new outputs to fetch, and its latency isn't a cook time
+		if (result == TEResultSuccess) {
+			// Without statistics the start-to-finish latency is the best cost estimate we have
+			if (!hasFrameStatistics && FrameStartNs != 0) {
+				LastFrameCostNs = GetSteadyTimeNs() - FrameStartNs;
+			}
+			hasNewTouchFrame = true;
+		}
 		isTouchFrameBusy = false;
 		break;
 	case TEEventInstanceReady:
@@ -1013,97 +2530,14 @@ void FFGLTouchEnginePluginBase::linkCallbackStatic(TEInstance* instance, TELinkE
 	static_cast<FFGLTouchEnginePluginBase*>(info)->linkCallback(event, identifier);
 }
 
-#ifdef __APPLE__
-GLuint FFGLTouchEnginePluginBase::CreateOpenGLTextureFromIOSurface(IOSurfaceRef surface, int width, int height)
-{
-	GLuint texture = 0;
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_RECTANGLE, texture);
-
-	CGLContextObj cglContext = CGLGetCurrentContext();
-	CGLError err = CGLTexImageIOSurface2D(
-		cglContext,
-		GL_TEXTURE_RECTANGLE,
-		GL_RGBA,
-		width,
-		height,
-		GL_BGRA,
-		GL_UNSIGNED_INT_8_8_8_8_REV,
-		surface,
-		0
-	);
-
-	if (err != kCGLNoError) {
-		FFGLLog::LogToHost("Failed to bind IOSurface to OpenGL texture");
-		glDeleteTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_RECTANGLE, 0);
-		return 0;
-	}
-
-	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glBindTexture(GL_TEXTURE_RECTANGLE, 0);
-
-	return texture;
-}
-
-IOSurfaceRef FFGLTouchEnginePluginBase::CreateIOSurface(int width, int height)
-{
-	NSDictionary *properties = @{
-		(NSString *)kIOSurfaceWidth: @(width),
-		(NSString *)kIOSurfaceHeight: @(height),
-		(NSString *)kIOSurfaceBytesPerElement: @(4),
-		(NSString *)kIOSurfacePixelFormat: @((uint32_t)'BGRA'),
-	};
-	return IOSurfaceCreate((__bridge CFDictionaryRef)properties);
-}
-
-id<MTLTexture> FFGLTouchEnginePluginBase::CreateIOSurfaceBackedMetalTexture(int width, int height, IOSurfaceRef* outSurface)
-{
-	// Create the IOSurface
-	IOSurfaceRef surface = CreateIOSurface(width, height);
-	if (surface == nullptr) {
-		FFGLLog::LogToHost("Failed to create IOSurface for Metal texture");
-		return nil;
-	}
-
-	// Create a Metal texture descriptor matching the IOSurface
-	MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm
-		width:width
-		height:height
-		mipmapped:NO];
-	desc.storageMode = MTLStorageModeShared;
-	desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
-
-	// Create Metal texture backed by the IOSurface
-	id<MTLTexture> texture = [MetalDevice newTextureWithDescriptor:desc iosurface:surface plane:0];
-	if (texture == nil) {
-		FFGLLog::LogToHost("Failed to create IOSurface-backed Metal texture");
-		CFRelease(surface);
-		return nil;
+void FFGLTouchEnginePluginBase::statisticsCallbackStatic(TEInstance* instance, const TEInstanceStatistics* statistics, void* info) {
+	FFGLTouchEnginePluginBase* plugin = static_cast<FFGLTouchEnginePluginBase*>(info);
+	if (plugin->isBeingDestroyed || statistics == nullptr || statistics->frames <= 0) {
+		return;
 	}
 
-	*outSurface = surface;
-	return texture;
+	// GPU time is the real limit on a shared GPU, but older TouchDesigner builds report -1
+	int64_t total = statistics->frameTimeGPU >= 0 ? statistics->frameTimeGPU : statistics->frameTimeCPU;
+	plugin->LastFrameCostNs = total / statistics->frames;
+	plugin->hasFrameStatistics = true;
 }
-
-void FFGLTouchEnginePluginBase::CopyMetalTexture(id<MTLTexture> src, id<MTLTexture> dst)
-{
-	id<MTLCommandBuffer> cmdBuf = [MetalCommandQueue commandBuffer];
-	id<MTLBlitCommandEncoder> blit = [cmdBuf blitCommandEncoder];
-	[blit copyFromTexture:src
-		sourceSlice:0
-		sourceLevel:0
-		sourceOrigin:MTLOriginMake(0, 0, 0)
-		sourceSize:MTLSizeMake(src.width, src.height, 1)
-		toTexture:dst
-		destinationSlice:0
-		destinationLevel:0
-		destinationOrigin:MTLOriginMake(0, 0, 0)];
-	[blit endEncoding];
-	[cmdBuf commit];
-	[cmdBuf waitUntilCompleted];
-}
-#endif
@@ -1,51 +1,75 @@
 #pragma once
 
-#ifdef _WIN32
-#include <windows.h>
-#include <d3d11_4.h>
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "user32.lib")
-#pragma comment(lib, "gdi32.lib")
-#define WIN32_LEAN_AND_MEAN
-#include <wrl.h>
-#include <shobjidl.h>
-#endif
-
-#ifdef __APPLE__
-#ifndef GL_SILENCE_DEPRECATION
-#define GL_SILENCE_DEPRECATION
-#endif
-#include <OpenGL/OpenGL.h>
-#include <OpenGL/gl3.h>
-#include <OpenGL/CGLIOSurface.h>
-#include <IOSurface/IOSurface.h>
-#import <Metal/Metal.h>
-#include <TouchEngine/TEMetal.h>
-#endif
-
 #include "FFGL/FFGLSDK.h"
+#include <array>
 #include <map>
+#include <memory>
 #include <string>
 #include "TouchEngine/TouchObject.h"
-
-#ifdef _WIN32
-#include "TouchEngine/TED3D11.h"
-#include "SpoutGL/SpoutSender.h"
-#endif
+#include "PresentationShader.h"
+#include "AdaptiveQualityController.h"
+#include "OutputRegistry.h"
+#include "TableData.h"
+#include "TriggerQueue.h"
+#include "ParameterSnapshot.h"
+#include "ControlChannel.h"
+#include "ToxIndexer.h"
+#include "UserDirectories.h"
+#include "TouchEngineGraphics.h"
+
+#include "TouchEngineAccounting.h"
 
 FFResult FailAndLog(std::string message);
 std::string GetSeverityString(TESeverity severity);
 std::string GenerateRandomString(size_t length);
 
-#ifdef _WIN32
-DXGI_FORMAT GlToDXFromat(GLint format);
-#endif
+//Plugin controls, indexed from ControlParamsOffset
+enum ControlParam : uint32_t {
+	ControlAlphaMode = 0,
+	ControlRenderScale,
+	ControlUpscaleFilter,
+	ControlAdaptiveQuality,
+	ControlFrameBudget,
+	ControlTickDivisor,
+	ControlTickRate,
+	ControlFrameBlend,
+	ControlInstanceName,
+	ControlOutputSelect,
+	ControlAudioFFT,
+	ControlPulseSpread,
+	ControlPage,
+	ControlSnapshot,
+	ControlSnapshotStore,
+	ControlSnapshotRecall,
+	ControlMorphTarget,
+	ControlMorph,
+	ControlExternalControl,
+	ControlToxLibrary,
+	ControlParamCount
+};
 
-GLenum GetGlType(GLint format);
+//Preallocated slot blocks, one per FFGL parameter type, MaxParamsByType slots each
+enum ParamBlock : uint32_t {
+	ParamBlockFloat = 0,
+	ParamBlockInt,
+	ParamBlockBool,
+	ParamBlockText,
+	ParamBlockPulse,
+	ParamBlockOption,
+	ParamBlockColor,
+	ParamBlockCount
+};
 
-#ifdef _WIN32
-GLenum GetGlType(DXGI_FORMAT format);
-#endif
+enum AlphaMode : int32_t {
+	AlphaModeStraight = 0,
+	AlphaModePremultiply,
+	AlphaModeUnpremultiply
+};
+
+enum UpscaleFilter : int32_t {
+	UpscaleFilterBilinear = 0,
+	UpscaleFilterBicubic
+};
 
 typedef struct {
 	std::string identifier;
@@ -53,10 +77,78 @@ typedef struct {
 	FFUInt32 children[4];
 } VectorParameterInfo;
 
+// What the host is told about a TouchEngine parameter, replayed when its page is shown.
+struct ParameterLayout {
+	std::string Label;
+	bool HasRange = false;
+	float Min = 0.0f;
+	float Max = 1.0f;
+	std::vector<std::string> Elements;//!< Option labels, empty for other types.
+	std::vector<float> ElementValues;
+};
+
+// One texture output link of a TouchEngine instance, copied into a GL texture the host can draw.
+// Shared through the OutputRegistry, so it is only fetched while someone presents it. Its GL
+// texture is freed with the last reference, which may be held by another instance presenting it.
+struct TouchEngineOutput {
+	~TouchEngineOutput();
+
+	// Frees the copy, the next fetch recreates it. Needs the host GL context.
+	void ReleaseResources();
+
+	std::string Identifier;//!< TouchEngine link identifier.
+	std::string Name;//!< Operator name, used in the registry key.
+	int Width = 0;
+	int Height = 0;
+	TETextureOrigin Origin = TETextureOriginTopLeft;
+	GLuint Texture = 0;
+	bool ExtendedRange = false;//!< Float texture, may hold values outside 0-1.
+	std::unique_ptr<TextureInterop> Interop;//!< Platform copy state, created by the first fetch.
+	std::atomic<uint32_t> Subscribers{ 0 };//!< Instances presenting this output, including its owner.
+};
+
+// A host input texture shared with the tox's matching inN link
+struct TouchEngineInput {
+	std::string Identifier;//!< Empty when the tox has no matching inN link.
+	int Width = 0;
+	int Height = 0;
+	GLint Format = 0;
+	std::unique_ptr<TextureInterop> Interop;//!< Platform copy state, reset whenever the host texture changes.
+};
+
+// One CHOP output of a TouchEngine instance, each channel is shown as a host parameter.
+struct ChannelOutput {
+	std::string Identifier;//!< TouchEngine link identifier.
+	std::string Name;//!< Operator name, prefixes the parameter names.
+	uint32_t FirstSlot = 0;//!< Index into the output parameter slots.
+	uint32_t Channels = 0;
+	bool Assigned = false;//!< Slots are assigned when the first value arrives.
+	std::vector<float> Min;//!< Per channel, starts at 0 and widens with every lower value seen.
+	std::vector<float> Max;//!< Per channel, starts at 1 and widens with every higher value seen.
+};
+
+// A DAT link shown as a host text parameter. Inputs take CSV/TSV text or a file path,
+// outputs are read-only and hold the table as TSV.
+struct TableLink {
+	std::string Identifier;//!< TouchEngine link identifier.
+	FFUInt32 ParamID = 0;
+	std::string Source;//!< Input text last applied to Table.
+	TouchObject<TETable> Table;//!< Last sent or received content, the base for cell diffs.
+};
+
+// Timestamped host changes of one float parameter, resampled into a time-dependent buffer each TouchEngine frame.
+struct AutomationChannel {
+	static constexpr uint32_t MaxEvents = 64;
+	std::array<std::pair<int64_t, float>, MaxEvents> Events;//!< Ring of changes since the last frame, oldest dropped on overflow.
+	uint32_t First = 0;
+	uint32_t Count = 0;
+	float Held = 0.0f;//!< Value at the end of the last delivered interval.
+};
+
 class FFGLTouchEnginePluginBase : public CFFGLPlugin
 {
 public:
-	FFGLTouchEnginePluginBase();
+	explicit FFGLTouchEnginePluginBase(std::unique_ptr<TouchEngineGraphics> graphics);
 	~FFGLTouchEnginePluginBase() override;
 
 	// //CFFGLPlugin
@@ -66,15 +158,54 @@ public:
 	
 	FFResult SetFloatParameter(unsigned int dwIndex, float value) override;
 	FFResult SetTextParameter(unsigned int dwIndex, const char* value) override;
+	FFUInt32 SetParamElementValue(unsigned int dwIndex, unsigned int elIndex, float newValue) override;
 
 	float GetFloatParameter(unsigned int index) override;
 	char* GetTextParameter(unsigned int index) override;
 
+	void SetBeatInfo(float bpm, float barPhase) override;
+	void SetSampleRate(unsigned int rate) override;
+
 protected:
 	FFResult InitializeDevice();
-	FFResult InitializeShader(const std::string& vertexShaderCode, const std::string& fragmentShaderCode);
-
-	void InitializeGlTexture(GLuint& texture, uint16_t width, uint16_t height, GLenum type);
+	FFResult InitializeShader();
+	uint32_t GetAlphaFeatures() const;
+	uint32_t GetOutputFeatures() const;
+	uint32_t GetOutputFeatures(const TouchEngineOutput& output) const;
+	TETextureOrigin GetHostTextureOrigin() const;
+
+	FFResult SetControlParameter(uint32_t control, float value);
+	float GetControlParameter(uint32_t control) const;
+	bool HandleReservedLink(const TouchObject<TELinkInfo>& linkInfo);
+	FFResult PushRenderResolution();
+	FFResult PushAudioFFT();
+	FFResult PushBeatInfo(int64_t frameNs);
+	FFResult PushPackedParameters();
+	FFResult PushAutomation(int64_t frameNs);
+	void RecordAutomation(FFUInt32 param, float value, int64_t timeNs);
+	float GetEffectiveRenderScale() const;
+
+	void BeginHostFrame();
+	bool ShouldStartFrame() const;
+	FFResult StartTouchFrame();
+	bool ConsumeNewTouchFrame();
+	void CapturePreviousFrame(const TouchEngineOutput& output);
+	void PresentOutput(const TouchEngineOutput& output);
+	void ReleaseFrameHistory();
+
+	void RegisterOutput(const TouchObject<TELinkInfo>& linkInfo);
+	void RegisterChannelOutput(const TouchObject<TELinkInfo>& linkInfo);
+	void ReadChannelOutputs();
+	void AssignChannelSlots(ChannelOutput& output, const TEFloatBuffer* buffer);
+	void PublishOutputs();
+	void ReleaseOutputs();
+	void RetireOutputs();
+	void ReleaseRetiredOutputs();
+	std::string GetInstanceName() const;
+	void ClaimDefaultInstanceName();
+	TouchEngineOutput* ResolvePresentedOutput();
+	FFResult UpdateOutputs(bool newFrame, GLuint hostFBO);
+	bool PresentLastOutput();
 
 	FFResult PushParametersToTouchEngine();
 
@@ -90,6 +221,33 @@ protected:
 	void GetAllParameters();
 	void CreateIndividualParameter(const TouchObject<TELinkInfo>& linkInfo);
 	void CreateParametersFromGroup(const TouchObject<TELinkInfo>& linkInfo);
+	void CreateTableParameter(const TouchObject<TELinkInfo>& linkInfo);
+
+	FFUInt32 AllocateParameter(ParamBlock block, uint32_t count = 1);
+	void ExposeParameter(FFUInt32 ParamID, const std::string& label);
+	void ExposeParameter(FFUInt32 ParamID, const std::string& label, float min, float max);
+	void ExposeParameter(FFUInt32 ParamID, const std::string& label, const std::vector<std::string>& elements, const std::vector<float>& values);
+	void ExposeParameter(FFUInt32 ParamID, ParameterLayout layout);
+	void ApplyParameterLayout(FFUInt32 slot, const ParameterLayout& layout);
+	void RaiseParameterValue(FFUInt32 ParamID);
+	void ShowPage(uint32_t page);
+	void UpdatePageControl();
+
+	void CaptureSnapshot(uint32_t slot);
+	void RecallSnapshot(uint32_t slot);
+	void BuildMorphTable();
+	void ApplyMorph();
+	void LoadSnapshots();
+
+	void ExposeSchema(const ToxSchema& schema);
+
+	void UpdateExternalControl();
+	void ApplyExternalValue(const char* identifier, double value, int64_t timeNs);
+	bool IsOnPage(FFUInt32 ParamID) const { return ParamID / PageStride == ParameterPage; }
+	FFUInt32 SlotToParameter(unsigned int slot) const { return ParameterPage * PageStride + slot; }
+	void RegisterTableOutput(const TouchObject<TELinkInfo>& linkInfo);
+	FFResult PushTableInputs();
+	void ReadTableOutputs();
 
 	virtual void HandleOperatorLink(const TouchObject<TELinkInfo>& linkInfo) = 0;
 
@@ -97,29 +255,7 @@ protected:
 	virtual void linkCallback(TELinkEvent event, const char* identifier);
 
 	TouchObject<TEInstance> instance;
-#ifdef _WIN32
-	Microsoft::WRL::ComPtr<ID3D11Device> D3DDevice;
-	TouchObject<TED3D11Context> D3DContext;
-	Microsoft::WRL::ComPtr <ID3D11Texture2D> D3DTextureInput = nullptr;
-	Microsoft::WRL::ComPtr <ID3D11Texture2D> D3DTextureOutput = nullptr;
-	std::map<ID3D11Texture2D*, IDXGIKeyedMutex*> TextureMutexMap;
-
-	DXGI_FORMAT DXFormat = DXGI_FORMAT_B8G8R8A8_UNORM;
-#endif
-#ifdef __APPLE__
-	id<MTLDevice> MetalDevice = nil;
-	id<MTLCommandQueue> MetalCommandQueue = nil;
-	TouchObject<TEMetalContext> MetalContext;
-
-	// Creates an IOSurface-backed Metal texture for sharing with OpenGL
-	id<MTLTexture> CreateIOSurfaceBackedMetalTexture(int width, int height, IOSurfaceRef* outSurface);
-	// Copies a TE Metal texture into our IOSurface-backed texture via Metal blit
-	void CopyMetalTexture(id<MTLTexture> src, id<MTLTexture> dst);
-	// Creates an OpenGL texture backed by an IOSurface for zero-copy sharing
-	GLuint CreateOpenGLTextureFromIOSurface(IOSurfaceRef surface, int width, int height);
-	// Creates an IOSurface suitable for texture sharing
-	IOSurfaceRef CreateIOSurface(int width, int height);
-#endif
+	std::unique_ptr<TouchEngineGraphics> Graphics;
 	GLint GLFormat = 0;
 
 	std::atomic_bool isTouchEngineLoaded;
@@ -137,6 +273,79 @@ protected:
 	//TouchEngine parameters
 	uint32_t MaxParamsByType = 0;
 	uint32_t OffsetParamsByType = 0;
+	uint32_t OutputParamsOffset = UINT32_MAX;
+	uint32_t ControlParamsOffset = UINT32_MAX;
+	int32_t AlphaModeValue = AlphaModeStraight;
+
+	//Render scale, the tox receives the scaled host resolution through reserved Renderwidth/Renderheight links
+	float RenderScale = 1.0f;
+	int32_t UpscaleFilterValue = UpscaleFilterBilinear;
+	std::string RenderWidthLink;
+	std::string RenderHeightLink;
+	int32_t SentRenderWidth = 0;
+	int32_t SentRenderHeight = 0;
+
+	//Host audio FFT, sent to a CHOP input named audiofft so the tox needs no audio device of its own
+	static constexpr uint32_t AudioFFTBins = 2048;
+	std::string AudioFFTLink;
+	TouchObject<TEFloatBuffer> AudioFFTBuffer;//!< Reused every frame, recreated when the sample rate changes.
+	std::vector<float> AudioFFTValues;//!< Written by the host bin by bin, handed to TouchEngine as is.
+	uint32_t AudioSampleRate = 44100;
+
+	//Host tempo, sent to reserved Bpm/Barphase links with the phase advanced to when the TouchEngine frame is shown
+	std::string BpmLink;
+	std::string BarPhaseLink;
+	double HostBpm = 0.0;
+	double HostBarPhase = 0.0;
+	int64_t BeatInfoNs = 0;//!< When the host last reported its beat info, 0 before the first report.
+	double SentBpm = -1.0;//!< Last value sent to the Bpm link, it is only sent again when it changes.
+
+	//Packed parameters, with a CHOP input named params every float parameter travels as one channel of a single buffer
+	std::string PackedParamsLink;
+	std::vector<FFUInt32> PackedParams;//!< Scalar float parameters in channel order.
+	std::vector<std::string> PackedNames;//!< Channel names, the parameter names of the tox.
+	TouchObject<TEFloatBuffer> PackedBuffer;//!< Created once the layout is known, reused every frame.
+	std::vector<float> PackedValues;
+	std::vector<const float*> PackedChannels;//!< One pointer per channel into PackedValues.
+	bool PackedSent = false;
+
+	//Automation, a CHOP input named automation receives float parameter changes at sub-frame resolution instead of once per frame.
+	//Only scalar float parameters are sampled, the channels follow PackedParams. Vector, int, bool, menu and string parameters
+	//still reach TouchEngine once per frame.
+	static constexpr uint32_t AutomationSamplesPerFrame = 8;//!< Per TouchEngine time step of 1/60 s.
+	static constexpr uint32_t AutomationMaxFrames = 8;//!< Longer gaps are not backfilled.
+	std::string AutomationLink;
+	std::vector<AutomationChannel> AutomationChannels;//!< Same order as PackedParams.
+	std::unordered_map<FFUInt32, uint32_t> AutomationIndex;
+	std::vector<float> AutomationSamples;//!< Channel-major staging, AutomationSamplesPerFrame * AutomationMaxFrames per channel.
+	std::vector<const float*> AutomationPointers;
+	std::vector<const char*> AutomationNames;//!< Point into PackedNames.
+	TouchObject<TEFloatBuffer> AutomationBuffer;//!< Refilled every frame, recreated with the channels.
+	int64_t LastAutomationNs = 0;
+
+	//Adaptive quality, holds the TouchEngine frame cost under budget by lowering scale then tick rate
+	AdaptiveQualityController QualityController;
+	bool AdaptiveQualityEnabled = false;
+	std::atomic<int64_t> LastFrameCostNs{ 0 };//!< Written from TouchEngine callbacks, consumed once per host frame.
+	std::atomic<int64_t> FrameStartNs{ 0 };//!< Fallback timing when no statistics are delivered.
+	std::atomic_bool hasFrameStatistics{ false };
+	uint64_t LastStartFrame = 0;
+
+	//TouchEngine tick rate, independent of the host frame rate
+	int32_t TickDivisor = 1;
+	float TickRate = 0.0f;//!< In Hz, 0 follows the host.
+	double TickPhase = 0.0;//!< TouchEngine ticks owed to the host clock when TickRate is set.
+	double HostFrameStep = 0.0;//!< TouchEngine ticks per host frame, from the last host frame duration.
+	int64_t LastHostFrameNs = 0;
+	double HostFrameSeconds = 1.0 / 60.0;//!< Duration of the last host frame.
+	std::atomic_bool hasNewTouchFrame{ false };
+
+	//Frame blending, mixes the previous TouchEngine frame in on the host frames between two ticks
+	bool FrameBlendEnabled = false;
+	ffglex::FFGLFBO PreviousFrame;
+	const TouchEngineOutput* PreviousFrameSource = nullptr;
+	uint64_t LastNewFrame = 0;
+	uint64_t NewFrameInterval = 1;
 	std::set<FFUInt32> ActiveParams;
 	std::vector<std::pair<std::string, FFUInt32>> Parameters;
 	std::unordered_map<FFUInt32, FFUInt32> ParameterMapType;
@@ -144,23 +353,71 @@ protected:
 	std::unordered_map<FFUInt32, double> ParameterMapFloat;
 	std::unordered_map<FFUInt32, std::string> ParameterMapString;
 	std::unordered_map<FFUInt32, bool> ParameterMapBool;
-	std::set<FFUInt32> PulseParameters;
-	uint32_t ColorParamCount = 0;
+	//Parameter pages, a TouchEngine parameter ID is page * PageStride + its FFGL slot so page 0 IDs are the slots themselves
+	static constexpr FFUInt32 PageStride = 1 << 16;
+	uint32_t ParameterPage = 0;//!< Page currently mapped onto the FFGL slots.
+	uint32_t PageCount = 1;
+	std::array<uint32_t, ParamBlockCount> BlockCounts{};//!< Slots handed out per block across all pages.
+	std::unordered_map<FFUInt32, ParameterLayout> ParameterLayouts;
+
+	//Snapshots, whole parameter tables stored in the plugin and recalled or morphed from a single control
+	static constexpr uint32_t SnapshotCount = 8;
+	std::vector<ParameterSnapshot> Snapshots;//!< Saved per tox in the user data directory.
+	std::shared_ptr<SnapshotBankWriter> SnapshotWriter;
+	int32_t SnapshotSlot = 0;
+	int32_t MorphTarget = 1;
+	float MorphAmount = 0.0f;
+	bool MorphDirty = false;//!< Morph moved since it was last applied.
+	bool MorphTableValid = false;
+	std::vector<FFUInt32> MorphParams;//!< Numeric parameters, one row of the morph table each.
+	std::vector<uint8_t> MorphIsInt;
+	std::vector<double> MorphFrom;
+	std::vector<double> MorphTo;
+	std::vector<double> MorphValues;
+
+	std::unordered_map<FFUInt32, std::unique_ptr<TriggerQueue>> PulseQueues;//!< Pulse parameters, each press is delivered once.
+	bool PulseSpreadEnabled = true;//!< One press per frame instead of merging the presses of a frame.
+
+	std::shared_ptr<ToxIndexer> Indexer;
+	std::string ToxLibrary;//!< Directory indexed in the background.
+
+	//External control, parameter changes written by other processes into a shared-memory ring named after the instance
+	bool ExternalControlEnabled = false;
+	std::atomic<bool> ExternalControlDirty{ false };//!< Channel name or parameters changed, reopen on the next host frame.
+	ControlChannel ExternalControl;
+	std::unordered_map<std::string, FFUInt32> ExternalControlIDs;
+	std::string ExternalIdentifier;//!< Lookup key reused across records.
 
 	std::set<FFUInt32> ActiveVectorParams;
 	std::vector<VectorParameterInfo> VectorParameters;
 
-	//Texture Name
-	std::string OutputOpName;
-
-	int OutputWidth = 0;
-	int OutputHeight = 0;
+	//Texture outputs, all of them are published so other instances can present them
+	std::vector<std::shared_ptr<TouchEngineOutput>> Outputs;
+	std::shared_ptr<TouchEngineOutput> PrimaryOutput;//!< out1, or the first texture output.
+	std::string InstanceName;//!< Registry prefix, DefaultInstanceName when empty.
+	std::string DefaultInstanceName;//!< Tox file name, with -2, -3... while other instances hold it.
+	std::string PublishedName;
+	std::string OutputSelect;//!< Empty for PrimaryOutput, "name" for an own output, "instance/name" for another's.
+	std::shared_ptr<TouchEngineOutput> PresentedOutput;
+	std::string PresentedKey;
+	std::vector<std::shared_ptr<TouchEngineOutput>> RetiredOutputs;//!< Dropped on a TouchEngine thread, let go of on the next frame.
+	std::mutex OutputsMutex;
+
+	//CHOP outputs, read back into parameters the host can map onto other effects
+	std::vector<ChannelOutput> ChannelOutputs;//!< Guarded by OutputsMutex.
+	std::vector<float> OutputParamValues;//!< One per output slot, preallocated.
+	uint32_t OutputParamCount = 0;//!< Output slots in use.
+
+	//DAT links, only sent or refreshed when a cell actually changed
+	std::vector<TableLink> TableInputs;
+	std::vector<TableLink> TableOutputs;//!< Guarded by OutputsMutex.
 
 	std::string FilePath;
 
-	ffglex::FFGLShader shader;  //!< Utility to help us compile and link some shaders into a program.
+	PresentationShader presentation;//!< Fused swizzle/flip/sub-rect/alpha pass used for every draw to the host.
 	ffglex::FFGLScreenQuad quad;//!< Utility to help us render a full screen quad.
 
 	static void eventCallbackStatic(TEInstance* instance, TEEvent event, TEResult result, int64_t start_time_value, int32_t start_time_scale, int64_t end_time_value, int32_t end_time_scale, void* info);
 	static void linkCallbackStatic(TEInstance* instance, TELinkEvent event, const char* identifier, void* info);
+	static void statisticsCallbackStatic(TEInstance* instance, const TEInstanceStatistics* statistics, void* info);
 };
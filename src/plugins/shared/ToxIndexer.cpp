@@ -0,0 +1,302 @@
+#include "ToxIndexer.h"
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+#include "FFGL/FFGLSDK.h"
+#include "PlatformSystem.h"
+
+// A tox that takes longer than this to load is skipped, it will load normally when used
+static constexpr auto LoadTimeout = std::chrono::seconds(60);
+
+std::shared_ptr<ToxIndexer> ToxIndexer::Acquire()
+{
+	static std::mutex acquireMutex;
+	static std::weak_ptr<ToxIndexer> shared;
+
+	std::lock_guard<std::mutex> lock(acquireMutex);
+	std::shared_ptr<ToxIndexer> indexer = shared.lock();
+	if (indexer == nullptr) {
+		indexer.reset(new ToxIndexer());
+		shared = indexer;
+	}
+	return indexer;
+}
+
+ToxIndexer::~ToxIndexer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	if (worker.joinable()) {
+		worker.join();
+	}
+}
+
+void ToxIndexer::AddDirectory(const std::string& directory)
+{
+	if (directory.empty()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		// Another layer already indexes it
+		if (directories[directory]++ > 0) {
+			return;
+		}
+		rescan = true;
+
+		if (!worker.joinable()) {
+			worker = std::thread(&ToxIndexer::Run, this);
+		}
+	}
+	wake.notify_all();
+}
+
+void ToxIndexer::RemoveDirectory(const std::string& directory)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = directories.find(directory);
+	if (it == directories.end() || --it->second > 0) {
+		return;
+	}
+	directories.erase(it);
+	// Stops the scan of the removed directory, the cached schemas stay
+	rescan = true;
+	wake.notify_all();
+}
+
+bool ToxIndexer::FindSchema(const std::string& toxPath, ToxSchema& schema)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = schemas.find(toxPath);
+		if (it != schemas.end() && IsSchemaCurrent(it->second, toxPath)) {
+			schema = it->second;
+			return true;
+		}
+	}
+
+	if (!LoadToxSchema(GetSchemaPath(toxPath), schema) || !IsSchemaCurrent(schema, toxPath)) {
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	schemas[toxPath] = schema;
+	return true;
+}
+
+void ToxIndexer::Run()
+{
+	// Indexing must never compete with rendering
+	SetBackgroundThreadPriority();
+
+	while (true) {
+		std::vector<std::string> roots;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return stopping || rescan; });
+			if (stopping) {
+				break;
+			}
+			rescan = false;
+			for (auto& directory : directories) {
+				roots.push_back(directory.first);
+			}
+		}
+
+		std::vector<std::string> files;
+		for (auto& root : roots) {
+			std::error_code error;
+			for (std::filesystem::recursive_directory_iterator it(root, std::filesystem::directory_options::skip_permission_denied, error), end; !error && it != end; it.increment(error)) {
+				if (it->is_regular_file(error) && it->path().extension() == ".tox") {
+					files.push_back(it->path().string());
+				}
+			}
+		}
+
+		uint32_t indexed = 0;
+		for (auto& file : files) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (stopping || rescan) {
+					break;
+				}
+			}
+
+			ToxSchema schema;
+			if (FindSchema(file, schema)) {
+				continue;
+			}
+			if (IndexFile(file)) {
+				indexed++;
+			}
+		}
+
+		// The worker instance is a whole TouchEngine process, don't keep it idle
+		instance.reset();
+
+		if (indexed > 0) {
+			FFGLLog::LogToHost(("Indexed " + std::to_string(indexed) + " tox files in the tox library").c_str());
+		}
+	}
+
+	instance.reset();
+}
+
+bool ToxIndexer::IndexFile(const std::string& toxPath)
+{
+	if (instance == nullptr) {
+		if (TEInstanceCreate(EventCallback, LinkCallback, this, instance.take()) != TEResultSuccess) {
+			instance.reset();
+			return false;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		loadDone = false;
+	}
+
+	if (TEInstanceConfigure(instance, toxPath.c_str(), TETimeExternal) != TEResultSuccess || TEInstanceLoad(instance) != TEResultSuccess) {
+		return false;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (!wake.wait_for(lock, LoadTimeout, [this] { return stopping || loadDone; }) || stopping || loadResult != TEResultSuccess) {
+			lock.unlock();
+			TEInstanceUnload(instance);
+			return false;
+		}
+	}
+
+	ToxSchema schema;
+	bool read = StampSchema(schema, toxPath) && ReadSchema(schema);
+	TEInstanceUnload(instance);
+
+	if (!read) {
+		return false;
+	}
+
+	if (SaveToxSchema(GetSchemaPath(toxPath), schema)) {
+		PruneSchemas(toxPath);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	schemas[toxPath] = std::move(schema);
+	return true;
+}
+
+bool ToxIndexer::ReadSchema(ToxSchema& schema)
+{
+	// Same walk as FFGLTouchEnginePluginBase::GetAllParameters, inputs first
+	for (TEScope scope : { TEScopeInput, TEScopeOutput }) {
+		TouchObject<TEStringArray> groups;
+		if (TEInstanceGetLinkGroups(instance, scope, groups.take()) != TEResultSuccess) {
+			return false;
+		}
+
+		for (int i = 0; i < groups->count; i++) {
+			TouchObject<TEStringArray> links;
+			if (TEInstanceLinkGetChildren(instance, groups->strings[i], links.take()) != TEResultSuccess) {
+				return false;
+			}
+
+			for (int j = 0; j < links->count; j++) {
+				ReadLink(links->strings[j], schema);
+			}
+		}
+	}
+
+	return true;
+}
+
+void ToxIndexer::ReadLink(const char* identifier, ToxSchema& schema)
+{
+	TouchObject<TELinkInfo> linkInfo;
+	if (TEInstanceLinkGetInfo(instance, identifier, linkInfo.take()) != TEResultSuccess) {
+		return;
+	}
+
+	// Parameter groups are flattened like CreateParametersFromGroup does
+	if (linkInfo->scope == TEScopeInput && linkInfo->domain == TELinkDomainParameter && linkInfo->type == TELinkTypeGroup) {
+		TouchObject<TEStringArray> children;
+		if (TEInstanceLinkGetChildren(instance, identifier, children.take()) != TEResultSuccess) {
+			return;
+		}
+		for (int i = 0; i < children->count; i++) {
+			ReadLink(children->strings[i], schema);
+		}
+		return;
+	}
+
+	ToxSchema::Link link;
+	link.Identifier = linkInfo->identifier;
+	link.Name = linkInfo->name != nullptr ? linkInfo->name : "";
+	link.Label = linkInfo->label != nullptr ? linkInfo->label : "";
+	link.Scope = linkInfo->scope;
+	link.Domain = linkInfo->domain;
+	link.Type = linkInfo->type;
+	link.Intent = linkInfo->intent;
+	link.Count = linkInfo->count;
+
+	if (link.Scope == TEScopeInput && link.Type == TELinkTypeDouble && link.Count > 0) {
+		link.Min.resize(link.Count);
+		link.Max.resize(link.Count);
+		link.Value.resize(link.Count);
+		TEInstanceLinkGetDoubleValue(instance, identifier, TELinkValueUIMinimum, link.Min.data(), link.Count);
+		TEInstanceLinkGetDoubleValue(instance, identifier, TELinkValueUIMaximum, link.Max.data(), link.Count);
+		TEInstanceLinkGetDoubleValue(instance, identifier, TELinkValueCurrent, link.Value.data(), link.Count);
+	} else if (link.Scope == TEScopeInput && link.Type == TELinkTypeInt && link.Count > 0) {
+		std::vector<int32_t> min(link.Count), max(link.Count), value(link.Count);
+		TEInstanceLinkGetIntValue(instance, identifier, TELinkValueUIMinimum, min.data(), link.Count);
+		TEInstanceLinkGetIntValue(instance, identifier, TELinkValueUIMaximum, max.data(), link.Count);
+		TEInstanceLinkGetIntValue(instance, identifier, TELinkValueCurrent, value.data(), link.Count);
+		link.Min.assign(min.begin(), min.end());
+		link.Max.assign(max.begin(), max.end());
+		link.Value.assign(value.begin(), value.end());
+
+		if (TEInstanceLinkHasChoices(instance, identifier)) {
+			TouchObject<TEStringArray> labels;
+			if (TEInstanceLinkGetChoiceLabels(instance, identifier, labels.take()) == TEResultSuccess && labels) {
+				for (int i = 0; i < labels->count; i++) {
+					link.Choices.push_back(labels->strings[i]);
+				}
+			}
+		}
+
+		if (link.Name == "Renderwidth") {
+			schema.RenderWidth = value[0];
+		} else if (link.Name == "Renderheight") {
+			schema.RenderHeight = value[0];
+		}
+	}
+
+	schema.Links.push_back(std::move(link));
+}
+
+void ToxIndexer::EventCallback(TEInstance*, TEEvent event, TEResult result, int64_t, int32_t, int64_t, int32_t, void* info)
+{
+	if (event != TEEventInstanceDidLoad) {
+		return;
+	}
+
+	ToxIndexer* indexer = static_cast<ToxIndexer*>(info);
+	{
+		std::lock_guard<std::mutex> lock(indexer->mutex);
+		indexer->loadDone = true;
+		// Component errors still leave the links readable
+		indexer->loadResult = result == TEResultComponentErrors ? TEResultSuccess : result;
+	}
+	indexer->wake.notify_all();
+}
+
+void ToxIndexer::LinkCallback(TEInstance*, TELinkEvent, const char*, void*)
+{
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "TouchEngine/TouchObject.h"
+#include "ToxSchema.h"
+
+// Scans tox library directories on a low priority thread and caches the schema of every
+// tox in the user cache directory, loading each stale file once in a worker TouchEngine instance. Shared
+// by all plugin instances in the process, it indexes the union of the directories they request and the
+// worker stops with the last of them.
+class ToxIndexer
+{
+public:
+	static std::shared_ptr<ToxIndexer> Acquire();
+	~ToxIndexer();
+
+	// Indexes every tox below 'directory' until each AddDirectory is matched by a RemoveDirectory.
+	// Empty directories are ignored.
+	void AddDirectory(const std::string& directory);
+	void RemoveDirectory(const std::string& directory);
+
+	// Finds a current schema for 'toxPath', from memory or the on-disk cache.
+	bool FindSchema(const std::string& toxPath, ToxSchema& schema);
+
+private:
+	ToxIndexer() = default;
+
+	void Run();
+	bool IndexFile(const std::string& toxPath);
+	bool ReadSchema(ToxSchema& schema);
+	void ReadLink(const char* identifier, ToxSchema& schema);
+
+	static void EventCallback(TEInstance* instance, TEEvent event, TEResult result, int64_t start_time_value, int32_t start_time_scale, int64_t end_time_value, int32_t end_time_scale, void* info);
+	static void LinkCallback(TEInstance* instance, TELinkEvent event, const char* identifier, void* info);
+
+	std::thread worker;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::map<std::string, uint32_t> directories;//!< Requesting instances per directory.
+	bool rescan = false;
+	bool stopping = false;
+	std::map<std::string, ToxSchema> schemas;
+
+	TouchObject<TEInstance> instance;//!< Only lives while there is a file to index.
+	bool loadDone = false;
+	TEResult loadResult = TEResultSuccess;
+};
@@ -0,0 +1,211 @@
+#include "ToxSchema.h"
+#include "UserDirectories.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+static const char SchemaMagic[4] = { 'T', 'E', 'S', 'C' };
+static constexpr uint32_t SchemaVersion = 1;
+
+template<typename T>
+static void Append(std::vector<uint8_t>& data, T value)
+{
+	size_t offset = data.size();
+	data.resize(offset + sizeof(T));
+	memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+template<typename T>
+static bool Extract(const std::vector<uint8_t>& data, size_t& offset, T& value)
+{
+	if (offset + sizeof(T) > data.size()) {
+		return false;
+	}
+	memcpy(&value, data.data() + offset, sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
+
+static void AppendString(std::vector<uint8_t>& data, const std::string& text)
+{
+	Append<uint32_t>(data, static_cast<uint32_t>(text.size()));
+	data.insert(data.end(), text.begin(), text.end());
+}
+
+static bool ExtractString(const std::vector<uint8_t>& data, size_t& offset, std::string& text)
+{
+	uint32_t length = 0;
+	if (!Extract(data, offset, length) || offset + length > data.size()) {
+		return false;
+	}
+	text.assign(reinterpret_cast<const char*>(data.data() + offset), length);
+	offset += length;
+	return true;
+}
+
+static void AppendNumbers(std::vector<uint8_t>& data, const std::vector<double>& numbers)
+{
+	Append<uint32_t>(data, static_cast<uint32_t>(numbers.size()));
+	for (double number : numbers) {
+		Append<double>(data, number);
+	}
+}
+
+static bool ExtractNumbers(const std::vector<uint8_t>& data, size_t& offset, std::vector<double>& numbers)
+{
+	uint32_t count = 0;
+	if (!Extract(data, offset, count) || offset + count * sizeof(double) > data.size()) {
+		return false;
+	}
+	numbers.resize(count);
+	for (double& number : numbers) {
+		Extract(data, offset, number);
+	}
+	return true;
+}
+
+std::string GetSchemaPath(const std::string& toxPath)
+{
+	std::string directory = GetUserCacheDirectory();
+	ToxSchema stamp;
+	if (directory.empty() || !StampSchema(stamp, toxPath)) {
+		return "";
+	}
+
+	// An edited tox gets a new entry instead of overwriting the one other versions may still use
+	char time[17];
+	snprintf(time, sizeof(time), "%016llx", static_cast<unsigned long long>(stamp.FileTime));
+	return (std::filesystem::path(directory) / (GetPathKey(toxPath) + "-" + time + ".schema")).string();
+}
+
+void PruneSchemas(const std::string& toxPath)
+{
+	std::string directory = GetUserCacheDirectory();
+	std::string current = GetSchemaPath(toxPath);
+	if (directory.empty() || current.empty()) {
+		return;
+	}
+
+	std::string prefix = GetPathKey(toxPath) + "-";
+	std::error_code error;
+	for (auto& entry : std::filesystem::directory_iterator(directory, error)) {
+		std::string name = entry.path().filename().string();
+		if (name.compare(0, prefix.size(), prefix) == 0 && entry.path().extension() == ".schema" && entry.path().string() != current) {
+			std::filesystem::remove(entry.path(), error);
+		}
+	}
+}
+
+bool StampSchema(ToxSchema& schema, const std::string& toxPath)
+{
+	std::error_code error;
+	std::filesystem::path path(toxPath);
+
+	uint64_t size = std::filesystem::file_size(path, error);
+	if (error) {
+		return false;
+	}
+	auto time = std::filesystem::last_write_time(path, error);
+	if (error) {
+		return false;
+	}
+
+	schema.FileSize = size;
+	schema.FileTime = static_cast<int64_t>(time.time_since_epoch().count());
+	return true;
+}
+
+bool IsSchemaCurrent(const ToxSchema& schema, const std::string& toxPath)
+{
+	ToxSchema stamp;
+	return StampSchema(stamp, toxPath) && stamp.FileSize == schema.FileSize && stamp.FileTime == schema.FileTime;
+}
+
+bool SaveToxSchema(const std::string& path, const ToxSchema& schema)
+{
+	std::vector<uint8_t> data(SchemaMagic, SchemaMagic + sizeof(SchemaMagic));
+	Append<uint32_t>(data, SchemaVersion);
+	Append<int64_t>(data, schema.FileTime);
+	Append<uint64_t>(data, schema.FileSize);
+	Append<int32_t>(data, schema.RenderWidth);
+	Append<int32_t>(data, schema.RenderHeight);
+	Append<uint32_t>(data, static_cast<uint32_t>(schema.Links.size()));
+
+	for (auto& link : schema.Links) {
+		AppendString(data, link.Identifier);
+		AppendString(data, link.Name);
+		AppendString(data, link.Label);
+		Append<int32_t>(data, link.Scope);
+		Append<int32_t>(data, link.Domain);
+		Append<int32_t>(data, link.Type);
+		Append<int32_t>(data, link.Intent);
+		Append<int32_t>(data, link.Count);
+		AppendNumbers(data, link.Min);
+		AppendNumbers(data, link.Max);
+		AppendNumbers(data, link.Value);
+		Append<uint32_t>(data, static_cast<uint32_t>(link.Choices.size()));
+		for (auto& choice : link.Choices) {
+			AppendString(data, choice);
+		}
+	}
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	return file.good();
+}
+
+bool LoadToxSchema(const std::string& path, ToxSchema& schema)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	size_t offset = sizeof(SchemaMagic);
+	uint32_t version = 0;
+	uint32_t count = 0;
+	if (data.size() < sizeof(SchemaMagic) || memcmp(data.data(), SchemaMagic, sizeof(SchemaMagic)) != 0 ||
+		!Extract(data, offset, version) || version != SchemaVersion ||
+		!Extract(data, offset, schema.FileTime) || !Extract(data, offset, schema.FileSize) ||
+		!Extract(data, offset, schema.RenderWidth) || !Extract(data, offset, schema.RenderHeight) ||
+		!Extract(data, offset, count)) {
+		return false;
+	}
+
+	schema.Links.clear();
+	for (uint32_t i = 0; i < count; i++) {
+		ToxSchema::Link link;
+		int32_t scope = 0, domain = 0, type = 0, intent = 0;
+		uint32_t choices = 0;
+		if (!ExtractString(data, offset, link.Identifier) || !ExtractString(data, offset, link.Name) || !ExtractString(data, offset, link.Label) ||
+			!Extract(data, offset, scope) || !Extract(data, offset, domain) || !Extract(data, offset, type) || !Extract(data, offset, intent) ||
+			!Extract(data, offset, link.Count) ||
+			!ExtractNumbers(data, offset, link.Min) || !ExtractNumbers(data, offset, link.Max) || !ExtractNumbers(data, offset, link.Value) ||
+			!Extract(data, offset, choices)) {
+			return false;
+		}
+
+		link.Scope = static_cast<TEScope>(scope);
+		link.Domain = static_cast<TELinkDomain>(domain);
+		link.Type = static_cast<TELinkType>(type);
+		link.Intent = static_cast<TELinkIntent>(intent);
+
+		link.Choices.resize(choices);
+		for (auto& choice : link.Choices) {
+			if (!ExtractString(data, offset, choice)) {
+				return false;
+			}
+		}
+
+		schema.Links.push_back(std::move(link));
+	}
+
+	return true;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "TouchEngine/TouchEngine.h"
+
+// The links of a tox as TouchEngine reported them, in the order the plugin visits them
+// when it builds its parameters. Cached in the user's cache directory so the parameter
+// layout is known before TouchEngine has loaded the file.
+struct ToxSchema
+{
+	struct Link {
+		std::string Identifier;
+		std::string Name;
+		std::string Label;
+		TEScope Scope = TEScopeInput;
+		TELinkDomain Domain = TELinkDomainParameter;
+		TELinkType Type = TELinkTypeDouble;
+		TELinkIntent Intent = TELinkIntentNotSpecified;
+		int32_t Count = 0;
+		std::vector<double> Min;//!< UI range and current value for number links, one per value.
+		std::vector<double> Max;
+		std::vector<double> Value;
+		std::vector<std::string> Choices;//!< Menu labels for int links with choices.
+	};
+
+	int64_t FileTime = 0;//!< Modification time of the tox the schema was read from.
+	uint64_t FileSize = 0;
+	int32_t RenderWidth = 0;//!< Defaults of the Renderwidth/Renderheight parameters, 0 when absent.
+	int32_t RenderHeight = 0;
+	std::vector<Link> Links;
+};
+
+// Cache file for the current version of 'toxPath', empty when the tox can't be read or there
+// is no cache directory.
+std::string GetSchemaPath(const std::string& toxPath);
+// Removes the cache files of older versions of 'toxPath'.
+void PruneSchemas(const std::string& toxPath);
+// True when 'schema' was read from the current version of the file at 'toxPath'.
+bool IsSchemaCurrent(const ToxSchema& schema, const std::string& toxPath);
+// Stamps 'schema' with the size and modification time of 'toxPath'.
+bool StampSchema(ToxSchema& schema, const std::string& toxPath);
+
+bool SaveToxSchema(const std::string& path, const ToxSchema& schema);
+bool LoadToxSchema(const std::string& path, ToxSchema& schema);
@@ -0,0 +1,37 @@
+#include "TriggerQueue.h"
+
+bool TriggerQueue::Push(int64_t timeNs)
+{
+	uint32_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) == Capacity) {
+		return false;
+	}
+
+	times[h % Capacity] = timeNs;
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+bool TriggerQueue::Pop(int64_t beforeNs)
+{
+	uint32_t t = tail.load(std::memory_order_relaxed);
+	if (t == head.load(std::memory_order_acquire)) {
+		return false;
+	}
+
+	if (times[t % Capacity] > beforeNs) {
+		return false;
+	}
+
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+uint32_t TriggerQueue::Drain(int64_t beforeNs)
+{
+	uint32_t count = 0;
+	while (Pop(beforeNs)) {
+		count++;
+	}
+	return count;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer, single consumer queue of trigger arrival times. The host
+// thread pushes a trigger per pulse press, from SetFloatParameter or from external control
+// records drained in BeginHostFrame, and frame submission pops them, so presses that arrive
+// between two TouchEngine frames, or while one is busy, are never lost.
+class TriggerQueue
+{
+public:
+	static constexpr uint32_t Capacity = 32;
+
+	// Producer side. Returns false and drops the trigger when the queue is full.
+	bool Push(int64_t timeNs);
+	// Consumer side, pops the oldest trigger if it arrived at or before 'beforeNs'.
+	bool Pop(int64_t beforeNs);
+	// Consumer side, pops every trigger that arrived at or before 'beforeNs' and returns how many.
+	uint32_t Drain(int64_t beforeNs);
+
+private:
+	std::array<int64_t, Capacity> times{};
+	std::atomic<uint32_t> head{ 0 };//!< Next slot to write, only advanced by the producer.
+	std::atomic<uint32_t> tail{ 0 };//!< Next slot to read, only advanced by the consumer.
+};
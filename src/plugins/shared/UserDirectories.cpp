@@ -0,0 +1,53 @@
+#include "UserDirectories.h"
+#include "PlatformSystem.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+
+static constexpr const char* DirectoryName = "FFGLTouchEngine";
+
+static std::string MakeDirectory(const std::filesystem::path& path)
+{
+	std::error_code error;
+	std::filesystem::create_directories(path, error);
+	if (error) {
+		return "";
+	}
+	return path.string();
+}
+
+std::string GetUserDataDirectory()
+{
+	std::filesystem::path root = GetUserDataRoot();
+	if (root.empty()) {
+		return "";
+	}
+	return MakeDirectory(root / DirectoryName);
+}
+
+std::string GetUserCacheDirectory()
+{
+	std::filesystem::path root = GetUserCacheRoot();
+	if (root.empty()) {
+		return "";
+	}
+	return MakeDirectory(root / DirectoryName);
+}
+
+std::string GetPathKey(const std::string& path)
+{
+	std::error_code error;
+	std::filesystem::path absolute = std::filesystem::absolute(path, error);
+	std::string full = error ? path : absolute.lexically_normal().string();
+
+	// FNV-1a, stable across runs and builds unlike std::hash
+	uint64_t hash = 14695981039346656037ull;
+	for (unsigned char c : full) {
+		hash = (hash ^ c) * 1099511628211ull;
+	}
+
+	char hex[17];
+	snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+	return std::filesystem::path(path).stem().string() + "-" + hex;
+}
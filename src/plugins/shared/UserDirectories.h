@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+// Per-user locations for the files the plugins keep about a tox. Nothing is written next to
+// the tox itself, which may sit in a read-only, shared or versioned folder.
+
+// Directory for data the user would miss if it was lost, such as snapshots. Created on first
+// use, empty when the user has no home directory.
+std::string GetUserDataDirectory();
+// Directory for files that can be rebuilt from the tox, such as schemas. Created on first use,
+// empty when the user has no home directory.
+std::string GetUserCacheDirectory();
+
+// File name identifying 'path' inside those directories: the tox name, for finding it by
+// hand, followed by a hash of the full path, so equally named tox files don't collide.
+std::string GetPathKey(const std::string& path);
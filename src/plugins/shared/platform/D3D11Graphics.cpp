@@ -0,0 +1,327 @@
+#include <windows.h>
+#include <d3d11_4.h>
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "user32.lib")
+#pragma comment(lib, "gdi32.lib")
+#include <wrl.h>
+
+#include "TouchEnginePluginBase.h"
+#include "TouchEngine/TED3D11.h"
+#include "SpoutGL/SpoutSender.h"
+
+#ifdef TE_ACCOUNTING
+#define TED3D11ContextGetTexture(context, ...) TE_ACCOUNT("TED3D11ContextGetTexture", nullptr, TED3D11ContextGetTexture(context, __VA_ARGS__))
+#endif
+
+// Windows backend: TouchEngine renders with D3D11 and textures cross to GL through Spout's
+// WGL_NV_DX_interop copies.
+
+static DXGI_FORMAT GlToDXFromat(GLint format) {
+
+	switch (format) {
+	case GL_RGBA8:
+		return DXGI_FORMAT_B8G8R8A8_UNORM;
+
+	case GL_RGB8:
+		return DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	case GL_RGBA16:
+		return DXGI_FORMAT_R16G16B16A16_UNORM;
+
+	default:
+		auto s = "Unsupported Format:: " + std::to_string(format);
+		FFGLLog::LogToHost(s.c_str());
+		return DXGI_FORMAT_B8G8R8A8_UNORM;
+	}
+}
+
+static GLenum GetGlType(GLint format) {
+	switch (format) {
+	case GL_RGBA16:
+		return GL_UNSIGNED_SHORT;
+	default:
+		return GL_UNSIGNED_BYTE;
+	}
+}
+
+static GLenum GetGlType(DXGI_FORMAT format) {
+	switch (format) {
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		return GL_UNSIGNED_BYTE;
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+		return GL_UNSIGNED_SHORT;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		return GL_FLOAT;
+	default:
+		return GL_UNSIGNED_BYTE;
+	}
+}
+
+static void InitializeGlTexture(GLuint& texture, uint16_t width, uint16_t height, GLenum type) {
+	if (texture != 0) {
+		glDeleteTextures(1, &texture);
+		texture = 0;
+	}
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, type, NULL);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+static void textureCallback(TED3D11Texture* texture, TEObjectEvent event, void* info)
+{
+	if (event == TEObjectEventRelease) {
+		FFGLLog::LogToHost("Releasing texture");
+	}
+	return;
+}
+
+// One Spout sender per texture, its D3D11 copy and the GL texture on the other side
+struct D3D11Interop : TextureInterop {
+	std::string SpoutID = GenerateRandomString(15);
+	Spout Interop;
+	bool InteropInitialized = false;
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> D3DTexture = nullptr;
+	DXGI_FORMAT Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+	GLuint SpoutTexture = 0;//!< Input side only, outputs copy into TouchEngineOutput::Texture.
+
+	~D3D11Interop() override {
+		if (InteropInitialized) {
+			Interop.CleanupInterop();
+			Interop.CloseDirectX();
+		}
+		D3DTexture.Reset();
+		if (SpoutTexture != 0) {
+			glDeleteTextures(1, &SpoutTexture);
+		}
+	}
+};
+
+class D3D11Graphics : public TouchEngineGraphics
+{
+public:
+	explicit D3D11Graphics(const char* logName) {
+		EnableSpoutLogFile(logName);
+	}
+
+	FFResult InitializeDevice() override;
+	bool AssociateContext(TEInstance* instance) override;
+	void ReleaseContext() override { D3DContext.reset(); }
+	void ReleaseGL() override {}
+
+	uint32_t GetTextureFeatures() const override { return 0; }
+
+	FFResult FetchOutput(TEInstance* instance, TouchEngineOutput& output, GLuint hostFBO) override;
+
+	FFResult CopyInput(TouchEngineInput& input, const FFGLTextureStruct& texture, GLuint hostFBO) override;
+	void FinishInputs() override {}
+	TEResult SendInput(TEInstance* instance, const TouchEngineInput& input, TETextureOrigin origin) override;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> D3DDevice;
+	TouchObject<TED3D11Context> D3DContext;
+};
+
+std::unique_ptr<TouchEngineGraphics> CreateTouchEngineGraphics(const char* logName)
+{
+	return std::make_unique<D3D11Graphics>(logName);
+}
+
+FFResult D3D11Graphics::InitializeDevice()
+{
+	// Create D3D11 device
+	HRESULT hr = D3D11CreateDevice(
+		nullptr,
+		D3D_DRIVER_TYPE_HARDWARE,
+		nullptr,
+		0,
+		nullptr,
+		0,
+		D3D11_SDK_VERSION,
+		D3DDevice.GetAddressOf(),
+		nullptr,
+		nullptr
+	);
+	if (FAILED(hr)) {
+		return FailAndLog("Failed to create D3D11 device");
+	}
+
+	return FF_SUCCESS;
+}
+
+bool D3D11Graphics::AssociateContext(TEInstance* instance)
+{
+	if (D3DDevice == nullptr) {
+		FFGLLog::LogToHost("D3D11 Device Not Available, You Probably Failed Somewhere...In Your Life");
+	}
+
+	TEResult result = TED3D11ContextCreate(D3DDevice.Get(), D3DContext.take());
+	if (result != TEResultSuccess) {
+		return false;
+	}
+
+	result = TEInstanceAssociateGraphicsContext(instance, D3DContext);
+	return result == TEResultSuccess;
+}
+
+FFResult D3D11Graphics::FetchOutput(TEInstance* instance, TouchEngineOutput& output, GLuint hostFBO)
+{
+	TouchObject<TETexture> TETextureToSend;
+	TEResult result = TEInstanceLinkGetTextureValue(instance, output.Identifier.c_str(), TELinkValueCurrent, TETextureToSend.take());
+	if (result != TEResultSuccess || TETextureToSend == nullptr) {
+		// Nothing new, the last copy stays valid
+		return FF_SUCCESS;
+	}
+
+	// TouchEngine may not honour the requested origin, trust the texture itself
+	output.Origin = TETextureGetOrigin(TETextureToSend);
+
+	if (output.Interop == nullptr) {
+		output.Interop = std::make_unique<D3D11Interop>();
+	}
+	D3D11Interop& interop = static_cast<D3D11Interop&>(*output.Interop);
+
+	if (TETextureGetType(TETextureToSend) == TETextureTypeD3DShared) {
+		TouchObject<TED3D11Texture> D3DTextureToSend;
+		result = TED3D11ContextGetTexture(D3DContext, static_cast<TED3DSharedTexture*>(TETextureToSend.get()), D3DTextureToSend.take());
+		if (result != TEResultSuccess)
+		{
+			return FF_FALSE;
+		}
+		ID3D11Texture2D* RawTextureToSend = TED3D11TextureGetTexture(D3DTextureToSend);
+
+		if (RawTextureToSend == nullptr) {
+			return FF_FALSE;
+		}
+
+		D3D11_TEXTURE2D_DESC RawTextureDesc;
+		ZeroMemory(&RawTextureDesc, sizeof(RawTextureDesc));
+
+		RawTextureToSend->GetDesc(&RawTextureDesc);
+
+		if (!interop.InteropInitialized || RawTextureDesc.Width != output.Width
+			|| RawTextureDesc.Height != output.Height
+			|| RawTextureDesc.Format != interop.Format) {
+
+			output.Width = RawTextureDesc.Width;
+			output.Height = RawTextureDesc.Height;
+
+			if (interop.InteropInitialized && !interop.Interop.CleanupInterop()) {
+				return FailAndLog("Failed to cleanup interop");
+			}
+			// A failure below leaves nothing to clean up, the next frame starts over
+			interop.InteropInitialized = false;
+
+			interop.Interop.SetSenderName(interop.SpoutID.c_str());
+
+			if (!interop.Interop.OpenDirectX11(D3DDevice.Get())) {
+				return FailAndLog("Failed to open DirectX11");
+			}
+
+			if (!interop.Interop.CreateInterop(output.Width, output.Height, RawTextureDesc.Format, false)) {
+				return FailAndLog("Failed to create interop");
+			}
+
+			interop.Interop.frame.CreateAccessMutex(interop.SpoutID.c_str());
+
+			if (!interop.Interop.spoutdx.CreateDX11Texture(D3DDevice.Get(), output.Width, output.Height, RawTextureDesc.Format, &interop.D3DTexture)) {
+				return FailAndLog("Failed to create DX11 texture");
+			}
+
+			InitializeGlTexture(output.Texture, output.Width, output.Height, GetGlType(RawTextureDesc.Format));
+			interop.Format = RawTextureDesc.Format;
+			output.ExtendedRange = RawTextureDesc.Format == DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+			interop.InteropInitialized = true;
+		}
+
+		// Released on every return below
+		Microsoft::WRL::ComPtr<IDXGIKeyedMutex> keyedMutex;
+		RawTextureToSend->QueryInterface(IID_PPV_ARGS(keyedMutex.GetAddressOf()));
+		if (keyedMutex == nullptr) {
+			return FF_FAIL;
+		}
+
+		TESemaphore* semaphore = nullptr;
+		uint64_t waitValue = 0;
+		if (TEInstanceHasTextureTransfer(instance, TETextureToSend) == false)
+		{
+			result = TEInstanceAddTextureTransfer(instance, TETextureToSend, semaphore, waitValue);
+			if (result != TEResultSuccess)
+			{
+				return FF_FAIL;
+			}
+		}
+		result = TEInstanceGetTextureTransfer(instance, TETextureToSend, &semaphore, &waitValue);
+		if (result != TEResultSuccess)
+		{
+			return FF_FALSE;
+		}
+		keyedMutex->AcquireSync(waitValue, INFINITE);
+
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> devContext;
+		D3DDevice->GetImmediateContext(&devContext);
+		devContext->CopyResource(interop.D3DTexture.Get(), RawTextureToSend);
+		interop.Interop.WriteTexture(interop.D3DTexture.GetAddressOf());
+		keyedMutex->ReleaseSync(waitValue + 1);
+
+		devContext->Flush();
+
+		result = TEInstanceAddTextureTransfer(instance, TETextureToSend, semaphore, waitValue + 1);
+		if (result != TEResultSuccess)
+		{
+			return FF_FAIL;
+		}
+	}
+
+	// Copy without inverting, the flip is folded into the presentation pass
+	interop.Interop.ReadGLDXtexture(output.Texture, GL_TEXTURE_2D, output.Width, output.Height, false, hostFBO);
+
+	return FF_SUCCESS;
+}
+
+FFResult D3D11Graphics::CopyInput(TouchEngineInput& input, const FFGLTextureStruct& texture, GLuint hostFBO)
+{
+	if (input.Interop == nullptr) {
+		auto interop = std::make_unique<D3D11Interop>();
+		interop->Interop.SetSenderName(interop->SpoutID.c_str());
+
+		if (!interop->Interop.OpenDirectX11(D3DDevice.Get())) {
+			return FailAndLog("Failed to open DirectX11");
+		}
+		interop->InteropInitialized = true;
+
+		if (!interop->Interop.CreateInterop(input.Width, input.Height, GlToDXFromat(input.Format), false)) {
+			return FailAndLog("Failed to create interop");
+		}
+
+		interop->Interop.frame.CreateAccessMutex(interop->SpoutID.c_str());
+
+		if (!interop->Interop.spoutdx.CreateDX11Texture(D3DDevice.Get(), input.Width, input.Height, GlToDXFromat(input.Format), &interop->D3DTexture)) {
+			return FailAndLog("Failed to create DX11 texture");
+		}
+
+		InitializeGlTexture(interop->SpoutTexture, input.Width, input.Height, GetGlType(input.Format));
+		input.Interop = std::move(interop);
+	}
+	D3D11Interop& interop = static_cast<D3D11Interop&>(*input.Interop);
+
+	interop.Interop.WriteGLDXtexture(texture.Handle, GL_TEXTURE_2D, input.Width, input.Height, false, hostFBO);
+	interop.Interop.ReadTexture(interop.D3DTexture.GetAddressOf());
+	return FF_SUCCESS;
+}
+
+TEResult D3D11Graphics::SendInput(TEInstance* instance, const TouchEngineInput& input, TETextureOrigin origin)
+{
+	const D3D11Interop& interop = static_cast<const D3D11Interop&>(*input.Interop);
+
+	TouchObject<TED3D11Texture> TETextureToReceive;
+	TETextureToReceive.take(TED3D11TextureCreate(interop.D3DTexture.Get(), origin, kTETextureComponentMapIdentity, (TED3D11TextureCallback)textureCallback, nullptr));
+
+	return TEInstanceLinkSetTextureValue(instance, input.Identifier.c_str(), TETextureToReceive, D3DContext);
+}
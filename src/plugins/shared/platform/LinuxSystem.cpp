@@ -0,0 +1,32 @@
+#include "PlatformSystem.h"
+
+#include <cstdlib>
+
+// The XDG directory, or its default below the home directory
+static std::filesystem::path GetXdgPath(const char* variable, const char* fallback)
+{
+	const char* value = getenv(variable);
+	if (value != nullptr && *value != '\0') {
+		return value;
+	}
+	const char* home = getenv("HOME");
+	if (home == nullptr || *home == '\0') {
+		return "";
+	}
+	return std::filesystem::path(home) / fallback;
+}
+
+std::filesystem::path GetUserDataRoot()
+{
+	return GetXdgPath("XDG_DATA_HOME", ".local/share");
+}
+
+std::filesystem::path GetUserCacheRoot()
+{
+	return GetXdgPath("XDG_CACHE_HOME", ".cache");
+}
+
+void SetBackgroundThreadPriority()
+{
+	// Left at the default, the Linux builds only run the benchmarks and soak tests
+}
@@ -0,0 +1,28 @@
+#include "PlatformSystem.h"
+
+#include <cstdlib>
+#include <pthread.h>
+
+static std::filesystem::path GetLibraryPath(const char* folder)
+{
+	const char* home = getenv("HOME");
+	if (home == nullptr || *home == '\0') {
+		return "";
+	}
+	return std::filesystem::path(home) / "Library" / folder;
+}
+
+std::filesystem::path GetUserDataRoot()
+{
+	return GetLibraryPath("Application Support");
+}
+
+std::filesystem::path GetUserCacheRoot()
+{
+	return GetLibraryPath("Caches");
+}
+
+void SetBackgroundThreadPriority()
+{
+	pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+}
@@ -0,0 +1,341 @@
+#include <OpenGL/OpenGL.h>
+#include <OpenGL/gl3.h>
+#include <OpenGL/CGLIOSurface.h>
+#include <IOSurface/IOSurface.h>
+#import <Metal/Metal.h>
+
+#include "TouchEnginePluginBase.h"
+#include "TouchEngine/TEMetal.h"
+
+#ifdef TE_ACCOUNTING
+#define TEMetalTextureGetTexture(texture) TE_ACCOUNT("TEMetalTextureGetTexture", nullptr, TEMetalTextureGetTexture(texture))
+#endif
+
+// macOS backend: TouchEngine renders with Metal and textures cross to GL through IOSurfaces,
+// which GL sees as BGRA rectangle textures.
+
+// An IOSurface seen both as a Metal texture and as a GL rectangle texture
+struct IOSurfaceInterop : TextureInterop {
+	IOSurfaceRef Surface = nullptr;
+	id<MTLTexture> MetalTexture = nil;
+	GLuint SurfaceGL = 0;//!< Input side only, outputs are bound to TouchEngineOutput::Texture.
+
+	~IOSurfaceInterop() override {
+		MetalTexture = nil;
+		if (Surface != nullptr) {
+			CFRelease(Surface);
+		}
+		if (SurfaceGL != 0) {
+			glDeleteTextures(1, &SurfaceGL);
+		}
+	}
+};
+
+class MetalGraphics : public TouchEngineGraphics
+{
+public:
+	~MetalGraphics() override {
+		MetalContext.reset();
+		MetalCommandQueue = nil;
+		MetalDevice = nil;
+	}
+
+	FFResult InitializeDevice() override;
+	bool AssociateContext(TEInstance* instance) override;
+	void ReleaseContext() override { MetalContext.reset(); }
+	void ReleaseGL() override;
+
+	// IOSurface output is a BGRA rectangle texture
+	uint32_t GetTextureFeatures() const override { return PresentationRectTexture | PresentationSwizzleBGRA; }
+
+	FFResult FetchOutput(TEInstance* instance, TouchEngineOutput& output, GLuint hostFBO) override;
+
+	FFResult CopyInput(TouchEngineInput& input, const FFGLTextureStruct& texture, GLuint hostFBO) override;
+	void FinishInputs() override;
+	TEResult SendInput(TEInstance* instance, const TouchEngineInput& input, TETextureOrigin origin) override;
+
+private:
+	id<MTLDevice> MetalDevice = nil;
+	id<MTLCommandQueue> MetalCommandQueue = nil;
+	TouchObject<TEMetalContext> MetalContext;
+	GLuint InputReadFBO = 0;//!< Shared by all inputs, rebound to each host texture in turn.
+	GLuint InputDrawFBO = 0;//!< Shared by all inputs, rebound to each IOSurface in turn.
+
+	// Creates an IOSurface-backed Metal texture for sharing with OpenGL
+	id<MTLTexture> CreateIOSurfaceBackedMetalTexture(int width, int height, IOSurfaceRef* outSurface);
+	// Copies a TE Metal texture into our IOSurface-backed texture via Metal blit
+	void CopyMetalTexture(id<MTLTexture> src, id<MTLTexture> dst);
+	// Creates an OpenGL texture backed by an IOSurface for zero-copy sharing
+	GLuint CreateOpenGLTextureFromIOSurface(IOSurfaceRef surface, int width, int height);
+	// Creates an IOSurface suitable for texture sharing
+	IOSurfaceRef CreateIOSurface(int width, int height);
+};
+
+std::unique_ptr<TouchEngineGraphics> CreateTouchEngineGraphics(const char*)
+{
+	return std::make_unique<MetalGraphics>();
+}
+
+FFResult MetalGraphics::InitializeDevice()
+{
+	if (MetalDevice == nil) {
+		MetalDevice = MTLCreateSystemDefaultDevice();
+		if (MetalDevice == nil) {
+			return FailAndLog("Failed to create Metal device");
+		}
+		MetalCommandQueue = [MetalDevice newCommandQueue];
+		if (MetalCommandQueue == nil) {
+			return FailAndLog("Failed to create Metal command queue");
+		}
+	}
+
+	return FF_SUCCESS;
+}
+
+bool MetalGraphics::AssociateContext(TEInstance* instance)
+{
+	if (MetalDevice == nil) {
+		FFGLLog::LogToHost("Metal Device Not Available");
+		return false;
+	}
+
+	TEResult result = TEMetalContextCreate(MetalDevice, MetalContext.take());
+	if (result != TEResultSuccess) {
+		FFGLLog::LogToHost("Failed to create TEMetalContext");
+		return false;
+	}
+
+	result = TEInstanceAssociateGraphicsContext(instance, MetalContext);
+	if (result != TEResultSuccess) {
+		FFGLLog::LogToHost("Failed to associate Metal graphics context");
+		return false;
+	}
+	return true;
+}
+
+void MetalGraphics::ReleaseGL()
+{
+	if (InputReadFBO != 0) {
+		glDeleteFramebuffers(1, &InputReadFBO);
+		InputReadFBO = 0;
+	}
+	if (InputDrawFBO != 0) {
+		glDeleteFramebuffers(1, &InputDrawFBO);
+		InputDrawFBO = 0;
+	}
+}
+
+FFResult MetalGraphics::FetchOutput(TEInstance* instance, TouchEngineOutput& output, GLuint hostFBO)
+{
+	TouchObject<TETexture> TETextureToSend;
+	TEResult result = TEInstanceLinkGetTextureValue(instance, output.Identifier.c_str(), TELinkValueCurrent, TETextureToSend.take());
+	if (result != TEResultSuccess || TETextureToSend == nullptr) {
+		// Nothing new, the last copy stays valid
+		return FF_SUCCESS;
+	}
+
+	// TouchEngine may not honour the requested origin, trust the texture itself
+	output.Origin = TETextureGetOrigin(TETextureToSend);
+
+	// Blit the new TouchEngine texture into our IOSurface-backed texture
+	TETextureType texType = TETextureGetType(TETextureToSend);
+	id<MTLTexture> srcTexture = nil;
+
+	if (texType == TETextureTypeMetal) {
+		srcTexture = TEMetalTextureGetTexture(static_cast<TEMetalTexture*>(TETextureToSend.get()));
+	} else if (texType == TETextureTypeIOSurface) {
+		IOSurfaceRef surface = TEIOSurfaceTextureGetSurface(static_cast<TEIOSurfaceTexture*>(TETextureToSend.get()));
+		if (surface != nullptr) {
+			int w = (int)IOSurfaceGetWidth(surface);
+			int h = (int)IOSurfaceGetHeight(surface);
+			MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm width:w height:h mipmapped:NO];
+			desc.storageMode = MTLStorageModeShared;
+			srcTexture = [MetalDevice newTextureWithDescriptor:desc iosurface:surface plane:0];
+		}
+	}
+
+	if (srcTexture != nil) {
+		int texWidth = (int)srcTexture.width;
+		int texHeight = (int)srcTexture.height;
+
+		// Recreate our IOSurface-backed texture if size changed
+		if (output.Interop == nullptr || texWidth != output.Width || texHeight != output.Height) {
+			output.ReleaseResources();
+			output.Width = texWidth;
+			output.Height = texHeight;
+
+			auto interop = std::make_unique<IOSurfaceInterop>();
+			interop->MetalTexture = CreateIOSurfaceBackedMetalTexture(output.Width, output.Height, &interop->Surface);
+			if (interop->MetalTexture != nil && interop->Surface != nullptr) {
+				output.Texture = CreateOpenGLTextureFromIOSurface(interop->Surface, output.Width, output.Height);
+			}
+			output.Interop = std::move(interop);
+		}
+
+		IOSurfaceInterop& interop = static_cast<IOSurfaceInterop&>(*output.Interop);
+		if (interop.MetalTexture != nil) {
+			CopyMetalTexture(srcTexture, interop.MetalTexture);
+		}
+
+		result = TEInstanceAddTextureTransfer(instance, TETextureToSend, nullptr, 0);
+	}
+
+	return FF_SUCCESS;
+}
+
+FFResult MetalGraphics::CopyInput(TouchEngineInput& input, const FFGLTextureStruct& texture, GLuint hostFBO)
+{
+	if (input.Interop == nullptr) {
+		auto interop = std::make_unique<IOSurfaceInterop>();
+		interop->MetalTexture = CreateIOSurfaceBackedMetalTexture(input.Width, input.Height, &interop->Surface);
+		if (interop->MetalTexture == nil || interop->Surface == nullptr) {
+			return FailAndLog("Failed to create IOSurface-backed Metal texture for input");
+		}
+
+		interop->SurfaceGL = CreateOpenGLTextureFromIOSurface(interop->Surface, input.Width, input.Height);
+		if (interop->SurfaceGL == 0) {
+			return FailAndLog("Failed to create GL texture from input IOSurface");
+		}
+		input.Interop = std::move(interop);
+	}
+	IOSurfaceInterop& interop = static_cast<IOSurfaceInterop&>(*input.Interop);
+
+	if (InputReadFBO == 0) {
+		glGenFramebuffers(1, &InputReadFBO);
+	}
+	if (InputDrawFBO == 0) {
+		glGenFramebuffers(1, &InputDrawFBO);
+	}
+
+	// Blit the used part of the host input texture into the IOSurface-backed rect texture
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, InputReadFBO);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.Handle, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, InputDrawFBO);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_RECTANGLE, interop.SurfaceGL, 0);
+	glBlitFramebuffer(0, 0, input.Width, input.Height, 0, 0, input.Width, input.Height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+	// Restore host FBO
+	glBindFramebuffer(GL_FRAMEBUFFER, hostFBO);
+	return FF_SUCCESS;
+}
+
+void MetalGraphics::FinishInputs()
+{
+	// One fence for the whole batch, TE reads the IOSurfaces only once GL is done with all of them
+	glFinish();
+}
+
+TEResult MetalGraphics::SendInput(TEInstance* instance, const TouchEngineInput& input, TETextureOrigin origin)
+{
+	const IOSurfaceInterop& interop = static_cast<const IOSurfaceInterop&>(*input.Interop);
+
+	// Send to TouchEngine as IOSurface texture
+	TouchObject<TEIOSurfaceTexture> inputTETex;
+	inputTETex.take(TEIOSurfaceTextureCreate(
+		interop.Surface,
+		TETextureFormatBGRA8Unorm,
+		0,
+		origin,
+		kTETextureComponentMapIdentity,
+		nullptr,
+		nullptr
+	));
+
+	return TEInstanceLinkSetTextureValue(instance, input.Identifier.c_str(), inputTETex, nullptr);
+}
+
+GLuint MetalGraphics::CreateOpenGLTextureFromIOSurface(IOSurfaceRef surface, int width, int height)
+{
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_RECTANGLE, texture);
+
+	CGLContextObj cglContext = CGLGetCurrentContext();
+	CGLError err = CGLTexImageIOSurface2D(
+		cglContext,
+		GL_TEXTURE_RECTANGLE,
+		GL_RGBA,
+		width,
+		height,
+		GL_BGRA,
+		GL_UNSIGNED_INT_8_8_8_8_REV,
+		surface,
+		0
+	);
+
+	if (err != kCGLNoError) {
+		FFGLLog::LogToHost("Failed to bind IOSurface to OpenGL texture");
+		glDeleteTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_RECTANGLE, 0);
+		return 0;
+	}
+
+	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_RECTANGLE, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_RECTANGLE, 0);
+
+	return texture;
+}
+
+IOSurfaceRef MetalGraphics::CreateIOSurface(int width, int height)
+{
+	NSDictionary *properties = @{
+		(__bridge NSString *)kIOSurfaceWidth: @(width),
+		(__bridge NSString *)kIOSurfaceHeight: @(height),
+		(__bridge NSString *)kIOSurfaceBytesPerElement: @(4),
+		(__bridge NSString *)kIOSurfacePixelFormat: @((uint32_t)'BGRA'),
+	};
+	return IOSurfaceCreate((__bridge CFDictionaryRef)properties);
+}
+
+id<MTLTexture> MetalGraphics::CreateIOSurfaceBackedMetalTexture(int width, int height, IOSurfaceRef* outSurface)
+{
+	// Create the IOSurface
+	IOSurfaceRef surface = CreateIOSurface(width, height);
+	if (surface == nullptr) {
+		FFGLLog::LogToHost("Failed to create IOSurface for Metal texture");
+		return nil;
+	}
+
+	// Create a Metal texture descriptor matching the IOSurface
+	MTLTextureDescriptor *desc = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm
+		width:width
+		height:height
+		mipmapped:NO];
+	desc.storageMode = MTLStorageModeShared;
+	desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageShaderWrite;
+
+	// Create Metal texture backed by the IOSurface
+	id<MTLTexture> texture = [MetalDevice newTextureWithDescriptor:desc iosurface:surface plane:0];
+	if (texture == nil) {
+		FFGLLog::LogToHost("Failed to create IOSurface-backed Metal texture");
+		CFRelease(surface);
+		return nil;
+	}
+
+	*outSurface = surface;
+	return texture;
+}
+
+void MetalGraphics::CopyMetalTexture(id<MTLTexture> src, id<MTLTexture> dst)
+{
+	// The host gives no autorelease pool, without one the command buffers pile up until it exits
+	@autoreleasepool {
+		id<MTLCommandBuffer> cmdBuf = [MetalCommandQueue commandBuffer];
+		id<MTLBlitCommandEncoder> blit = [cmdBuf blitCommandEncoder];
+		[blit copyFromTexture:src
+			sourceSlice:0
+			sourceLevel:0
+			sourceOrigin:MTLOriginMake(0, 0, 0)
+			sourceSize:MTLSizeMake(src.width, src.height, 1)
+			toTexture:dst
+			destinationSlice:0
+			destinationLevel:0
+			destinationOrigin:MTLOriginMake(0, 0, 0)];
+		[blit endEncoding];
+		[cmdBuf commit];
+		[cmdBuf waitUntilCompleted];
+	}
+}
@@ -0,0 +1,169 @@
+#include "TouchEnginePluginBase.h"
+#include "TouchEngine/TEOpenGL.h"
+
+// Linux backend: Derivative ships no TouchEngine for Linux, so this runs against the stub, which
+// makes its GL textures on the host's context. There is no device or context to share, textures
+// are copied with framebuffer blits.
+
+static bool IsFloatFormat(GLint format) {
+	switch (format) {
+	case GL_R16F:
+	case GL_R32F:
+	case GL_RG16F:
+	case GL_RG32F:
+	case GL_RGBA16F:
+	case GL_RGBA32F:
+	case GL_R11F_G11F_B10F:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void InitializeGlTexture(GLuint& texture, int width, int height, GLint internalFormat) {
+	if (texture != 0) {
+		glDeleteTextures(1, &texture);
+		texture = 0;
+	}
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// The format a copy is made in. Outputs keep TouchEngine's texture, inputs get a texture of their own.
+struct GLTextureInterop : TextureInterop {
+	GLint Format = 0;
+	GLuint Texture = 0;//!< Input side only, outputs copy into TouchEngineOutput::Texture.
+
+	~GLTextureInterop() override {
+		if (Texture != 0) {
+			glDeleteTextures(1, &Texture);
+		}
+	}
+};
+
+class OpenGLGraphics : public TouchEngineGraphics
+{
+public:
+	FFResult InitializeDevice() override { return FF_SUCCESS; }
+	bool AssociateContext(TEInstance*) override { return true; }
+	void ReleaseContext() override {}
+	void ReleaseGL() override;
+
+	uint32_t GetTextureFeatures() const override { return 0; }
+
+	FFResult FetchOutput(TEInstance* instance, TouchEngineOutput& output, GLuint hostFBO) override;
+
+	FFResult CopyInput(TouchEngineInput& input, const FFGLTextureStruct& texture, GLuint hostFBO) override;
+	// The stub reads inputs on the host's context, after the copies
+	void FinishInputs() override {}
+	TEResult SendInput(TEInstance* instance, const TouchEngineInput& input, TETextureOrigin origin) override;
+
+private:
+	GLuint ReadFBO = 0;
+	GLuint DrawFBO = 0;
+
+	void Blit(GLuint source, GLenum sourceTarget, GLuint destination, int width, int height, GLuint hostFBO);
+};
+
+std::unique_ptr<TouchEngineGraphics> CreateTouchEngineGraphics(const char*)
+{
+	return std::make_unique<OpenGLGraphics>();
+}
+
+void OpenGLGraphics::ReleaseGL()
+{
+	if (ReadFBO != 0) {
+		glDeleteFramebuffers(1, &ReadFBO);
+		ReadFBO = 0;
+	}
+	if (DrawFBO != 0) {
+		glDeleteFramebuffers(1, &DrawFBO);
+		DrawFBO = 0;
+	}
+}
+
+void OpenGLGraphics::Blit(GLuint source, GLenum sourceTarget, GLuint destination, int width, int height, GLuint hostFBO)
+{
+	if (ReadFBO == 0) {
+		glGenFramebuffers(1, &ReadFBO);
+	}
+	if (DrawFBO == 0) {
+		glGenFramebuffers(1, &DrawFBO);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, ReadFBO);
+	glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, sourceTarget, source, 0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, DrawFBO);
+	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, destination, 0);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, hostFBO);
+}
+
+FFResult OpenGLGraphics::FetchOutput(TEInstance* instance, TouchEngineOutput& output, GLuint hostFBO)
+{
+	TouchObject<TETexture> TETextureToSend;
+	TEResult result = TEInstanceLinkGetTextureValue(instance, output.Identifier.c_str(), TELinkValueCurrent, TETextureToSend.take());
+	if (result != TEResultSuccess || TETextureToSend == nullptr || TETextureGetType(TETextureToSend) != TETextureTypeOpenGL) {
+		// Nothing new, the last copy stays valid
+		return FF_SUCCESS;
+	}
+
+	// TouchEngine may not honour the requested origin, trust the texture itself
+	output.Origin = TETextureGetOrigin(TETextureToSend);
+
+	const TEOpenGLTexture* source = static_cast<const TEOpenGLTexture*>(TETextureToSend.get());
+	int width = TEOpenGLTextureGetWidth(source);
+	int height = TEOpenGLTextureGetHeight(source);
+	GLint format = TEOpenGLTextureGetInternalFormat(source);
+
+	if (output.Interop == nullptr || width != output.Width || height != output.Height
+		|| format != static_cast<GLTextureInterop&>(*output.Interop).Format) {
+		output.ReleaseResources();
+		output.Width = width;
+		output.Height = height;
+
+		auto interop = std::make_unique<GLTextureInterop>();
+		interop->Format = format;
+		output.Interop = std::move(interop);
+
+		InitializeGlTexture(output.Texture, output.Width, output.Height, format);
+		output.ExtendedRange = IsFloatFormat(format);
+	}
+
+	// Copy without inverting, the flip is folded into the presentation pass
+	Blit(TEOpenGLTextureGetName(source), TEOpenGLTextureGetTarget(source), output.Texture, output.Width, output.Height, hostFBO);
+	return FF_SUCCESS;
+}
+
+FFResult OpenGLGraphics::CopyInput(TouchEngineInput& input, const FFGLTextureStruct& texture, GLuint hostFBO)
+{
+	if (input.Interop == nullptr) {
+		auto interop = std::make_unique<GLTextureInterop>();
+		// Some drivers report the unsized format the host asked for, TouchEngine needs a sized one
+		interop->Format = input.Format == GL_RGBA || input.Format == 0 ? GL_RGBA8 : input.Format;
+		InitializeGlTexture(interop->Texture, input.Width, input.Height, interop->Format);
+		input.Interop = std::move(interop);
+	}
+	GLTextureInterop& interop = static_cast<GLTextureInterop&>(*input.Interop);
+
+	Blit(texture.Handle, GL_TEXTURE_2D, interop.Texture, input.Width, input.Height, hostFBO);
+	return FF_SUCCESS;
+}
+
+TEResult OpenGLGraphics::SendInput(TEInstance* instance, const TouchEngineInput& input, TETextureOrigin origin)
+{
+	const GLTextureInterop& interop = static_cast<const GLTextureInterop&>(*input.Interop);
+
+	TouchObject<TEOpenGLTexture> TETextureToReceive;
+	TETextureToReceive.take(TEOpenGLTextureCreate(interop.Texture, GL_TEXTURE_2D, interop.Format, input.Width, input.Height, origin, kTETextureComponentMapIdentity, nullptr, nullptr));
+
+	return TEInstanceLinkSetTextureValue(instance, input.Identifier.c_str(), TETextureToReceive, nullptr);
+}
@@ -0,0 +1,48 @@
+#include "PlatformSystem.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Shared by macOS and Linux
+
+bool OpenSharedMemory(const std::string& name, size_t size, SharedMemory& region)
+{
+	// macOS limits shared-memory names to 31 characters
+	std::string regionName = ("/" + name).substr(0, 31);
+	int descriptor = shm_open(regionName.c_str(), O_CREAT | O_RDWR, 0666);
+	if (descriptor < 0) {
+		return false;
+	}
+
+	// An existing region keeps its size, macOS refuses to resize it
+	struct stat info;
+	if (fstat(descriptor, &info) != 0 || (static_cast<size_t>(info.st_size) < size && ftruncate(descriptor, size) != 0)) {
+		close(descriptor);
+		return false;
+	}
+
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	if (memory == MAP_FAILED) {
+		close(descriptor);
+		return false;
+	}
+
+	region.Memory = memory;
+	region.Size = size;
+	region.Handle = descriptor;
+	return true;
+}
+
+void CloseSharedMemory(SharedMemory& region)
+{
+	if (region.Memory != nullptr) {
+		munmap(region.Memory, region.Size);
+	}
+	if (region.Handle >= 0) {
+		// The region is not unlinked, other processes stay attached
+		close(static_cast<int>(region.Handle));
+	}
+	region = SharedMemory();
+}
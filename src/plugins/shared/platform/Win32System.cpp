@@ -0,0 +1,56 @@
+#include "PlatformSystem.h"
+
+#include <cstdlib>
+#include <windows.h>
+
+static std::filesystem::path GetEnvironmentPath(const char* name)
+{
+	const char* value = getenv(name);
+	return value != nullptr ? value : "";
+}
+
+std::filesystem::path GetUserDataRoot()
+{
+	return GetEnvironmentPath("APPDATA");
+}
+
+std::filesystem::path GetUserCacheRoot()
+{
+	return GetEnvironmentPath("LOCALAPPDATA");
+}
+
+void SetBackgroundThreadPriority()
+{
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+}
+
+bool OpenSharedMemory(const std::string& name, size_t size, SharedMemory& region)
+{
+	std::string regionName = "Local\\" + name;
+	HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(size), regionName.c_str());
+	if (mapping == nullptr) {
+		return false;
+	}
+
+	void* memory = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	if (memory == nullptr) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	region.Memory = memory;
+	region.Size = size;
+	region.Handle = reinterpret_cast<intptr_t>(mapping);
+	return true;
+}
+
+void CloseSharedMemory(SharedMemory& region)
+{
+	if (region.Memory != nullptr) {
+		UnmapViewOfFile(region.Memory);
+	}
+	if (region.Handle != -1) {
+		CloseHandle(reinterpret_cast<HANDLE>(region.Handle));
+	}
+	region = SharedMemory();
+}
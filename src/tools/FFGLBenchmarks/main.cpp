@@ -0,0 +1,505 @@
+// Microbenchmarks for the parameter hot paths of the plugin: parameter discovery, pushing
+// the parameters to TouchEngine, the host's parameter reads and writes, the SDK's parameter
+// lookup and event queue, and the cost of going through plugMain. Each benchmark runs against
+// a loaded tox with 10, 100 and 1000 float parameters and reports nanoseconds and heap
+// allocations per operation, so a change to one of these paths can be compared before and
+// after on the same machine. The parameters come from the stub's TE_STUB_PARAMETERS, against
+// TouchEngine the tox's own parameters are measured.
+//
+// A second suite loads each tox of Example/ into the plugin binaries the way a host does,
+// through HeadlessHost, and renders frames with automation on every parameter. Against
+// the stub, the tox files load with the links, output and cook time in StubToxShapes.h.
+//
+// Usage: FFGLBenchmarks [--time <ms per benchmark>] [--suite synthetic|scenarios]
+//                       [--frames 300] [--warmup 120]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FFGL/FFGLSDK.h"
+#include "HeadlessHost.h"
+#include "StubToxShapes.h"
+#include "TouchEnginePluginBase.h"
+
+// Every allocation in the process is counted, including the ones made inside the SDK
+static std::atomic<uint64_t> Allocations{ 0 };
+
+void* operator new(size_t size) {
+	Allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = malloc(size > 0 ? size : 1)) {
+		return memory;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	free(memory);
+}
+
+class BenchmarkPlugin : public FFGLTouchEnginePluginBase
+{
+public:
+	BenchmarkPlugin()
+		: FFGLTouchEnginePluginBase(CreateTouchEngineGraphics("FFGLBenchmarks.log")) {
+		ConstructBaseParameters();
+	}
+
+	FFResult InitGL(const FFGLViewportStruct* vp) override {
+		FFResult result = InitializeDevice();
+		if (result == FF_SUCCESS) {
+			LoadTouchEngine();
+		}
+		return result;
+	}
+
+	FFResult ProcessOpenGL(ProcessOpenGLStruct* pGL) override {
+		return FF_SUCCESS;
+	}
+
+	FFResult DeInitGL() override {
+		return FF_SUCCESS;
+	}
+
+	// Loads the tox and waits until TouchEngine has loaded it, its parameters are read by Discover
+	bool Load(const std::string& path) {
+		FilePath = path;
+		if (!LoadTEFile()) {
+			return false;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		while (!isTouchEngineLoaded || !isTouchEngineReady) {
+			if (std::chrono::steady_clock::now() - start > std::chrono::seconds(10)) {
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return true;
+	}
+
+	// What a load does once TouchEngine reports the tox, and the outputs it replaces freed the
+	// way the next frame frees them
+	void Discover() {
+		GetAllParameters();
+		ReleaseRetiredOutputs();
+	}
+
+	FFResult PushParameters() {
+		return PushParametersToTouchEngine();
+	}
+
+	uint32_t GetParameterCount() const {
+		return static_cast<uint32_t>(ActiveParams.size());
+	}
+
+	// FFGL slots of the discovered parameters on the current page, in slot order
+	std::vector<unsigned int> GetVisibleSlots(bool floatsOnly) const {
+		std::vector<unsigned int> slots;
+		for (auto& layout : ParameterLayouts) {
+			if (!IsOnPage(layout.first)) {
+				continue;
+			}
+			unsigned int slot = layout.first % PageStride;
+			if (!floatsOnly || GetParamType(slot) != FF_TYPE_TEXT) {
+				slots.push_back(slot);
+			}
+		}
+		std::sort(slots.begin(), slots.end());
+		return slots;
+	}
+
+	bool HasParamInfo(unsigned int slot) {
+		return FindParamInfo(slot) != nullptr;
+	}
+
+	void RaiseValueEvents(const std::vector<unsigned int>& slots) {
+		for (unsigned int slot : slots) {
+			RaiseParamEvent(slot, FF_EVENT_FLAG_VALUE);
+		}
+	}
+
+private:
+	void ResumeTouchEngine() override {
+	}
+
+	void ClearTouchInstance() override {
+	}
+
+	void HandleOperatorLink(const TouchObject<TELinkInfo>& linkInfo) override {
+	}
+};
+
+static CFFGLPluginInfo PluginInfo(
+	PluginFactory< BenchmarkPlugin >,// Create method
+	"TEBM",                        // Plugin unique ID
+	"TouchEngineBenchmark",        // Plugin name
+	2,                             // API major version number
+	1,                             // API minor version number
+	1,                             // Plugin major version number
+	000,                           // Plugin minor version number
+	FF_EFFECT,                     // Plugin type
+	"Parameter path benchmarks",   // Plugin description
+	"TouchEngine Loader made by Evan Clark"        // About
+);
+
+struct BenchmarkResult {
+	double NsPerOp = 0.0;
+	double AllocationsPerOp = 0.0;
+};
+
+static int64_t BenchmarkTimeNs = 200 * 1000000LL;
+
+// Runs 'op' in growing batches until BenchmarkTimeNs has passed
+template<typename Op>
+static BenchmarkResult Measure(Op&& op) {
+	// Warm up, first calls fill caches and grow containers to their working size
+	for (uint64_t i = 0; i < 16; i++) {
+		op(i);
+	}
+
+	uint64_t iterations = 0;
+	uint64_t batch = 1;
+	uint64_t allocations = Allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	int64_t elapsed = 0;
+	while (elapsed < BenchmarkTimeNs) {
+		for (uint64_t i = 0; i < batch; i++) {
+			op(iterations + i);
+		}
+		iterations += batch;
+		batch = std::min<uint64_t>(batch * 2, 1 << 20);
+		elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	BenchmarkResult result;
+	result.NsPerOp = static_cast<double>(elapsed) / iterations;
+	result.AllocationsPerOp = static_cast<double>(Allocations.load() - allocations) / iterations;
+	return result;
+}
+
+static void Report(const char* name, uint32_t count, const BenchmarkResult& result) {
+	printf("%-38s %6u %14.1f %14.2f\n", name, count, result.NsPerOp, result.AllocationsPerOp);
+}
+
+static FFMixed CallPlugMain(FFUInt32 functionCode, FFMixed inputValue, CFFGLPlugin* plugin) {
+	return plugMain(functionCode, inputValue, reinterpret_cast<FFInstanceID>(plugin));
+}
+
+// TE_STUB_PARAMETERS is read by the stub on every load
+static void SetStubParameterCount(uint32_t count) {
+	std::string value = std::to_string(count);
+#ifdef _WIN32
+	_putenv_s("TE_STUB_PARAMETERS", value.c_str());
+#else
+	setenv("TE_STUB_PARAMETERS", value.c_str(), 1);
+#endif
+}
+
+static bool RunSyntheticSuite() {
+	std::string tox = std::string(EXAMPLE_DIRECTORY) + "/NoiseOutOnly.tox";
+	printf("%-38s %6s %14s %14s\n", "Benchmark", "Params", "ns/op", "allocs/op");
+
+	static const uint32_t Counts[] = { 10, 100, 1000 };
+	for (uint32_t count : Counts) {
+		SetStubParameterCount(count);
+		BenchmarkPlugin plugin;
+		if (plugin.InitGL(nullptr) != FF_SUCCESS || !plugin.Load(tox)) {
+			printf("Failed to load %s with %u parameters\n", tox.c_str(), count);
+			return false;
+		}
+
+		plugin.Discover();
+		std::vector<unsigned int> slots = plugin.GetVisibleSlots(true);
+		std::vector<unsigned int> allSlots = plugin.GetVisibleSlots(false);
+		uint32_t params = plugin.GetParameterCount();
+		if (slots.empty()) {
+			printf("%s has no float parameters\n", tox.c_str());
+			return false;
+		}
+
+		Report("Discovery (GetAllParameters)", params, Measure([&](uint64_t) {
+			plugin.Discover();
+		}));
+
+		plugin.Discover();
+		Report("PushParametersToTouchEngine", params, Measure([&](uint64_t) {
+			plugin.PushParameters();
+		}));
+
+		Report("SetFloatParameter", params, Measure([&](uint64_t i) {
+			plugin.SetFloatParameter(slots[i % slots.size()], static_cast<float>(i & 0xff) / 255.0f);
+		}));
+
+		volatile float sink = 0.0f;
+		Report("GetFloatParameter", params, Measure([&](uint64_t i) {
+			sink = sink + plugin.GetFloatParameter(slots[i % slots.size()]);
+		}));
+
+		volatile bool found = false;
+		Report("FindParamInfo", params, Measure([&](uint64_t i) {
+			found = plugin.HasParamInfo(allSlots[i % allSlots.size()]);
+		}));
+
+		// One op raises a value event on every visible parameter and consumes them all
+		std::vector<ParamEventStruct> events(plugin.GetNumParams());
+		Report("RaiseParamEvent + ConsumeParamEvents", params, Measure([&](uint64_t) {
+			plugin.RaiseValueEvents(allSlots);
+			plugin.ConsumeParamEvents(events.data(), static_cast<FFUInt32>(events.size()));
+		}));
+
+		SetParameterStruct setParameter;
+		FFMixed setValue;
+		setValue.PointerValue = &setParameter;
+		Report("plugMain FF_SET_PARAMETER", params, Measure([&](uint64_t i) {
+			float value = static_cast<float>(i & 0xff) / 255.0f;
+			setParameter.ParameterNumber = slots[i % slots.size()];
+			memcpy(&setParameter.NewParameterValue.UIntValue, &value, sizeof(value));
+			CallPlugMain(FF_SET_PARAMETER, setValue, &plugin);
+		}));
+
+		FFMixed getValue;
+		Report("plugMain FF_GET_PARAMETER", params, Measure([&](uint64_t i) {
+			getValue.UIntValue = slots[i % slots.size()];
+			found = CallPlugMain(FF_GET_PARAMETER, getValue, &plugin).UIntValue != 0;
+		}));
+	}
+	return true;
+}
+
+static uint32_t ScenarioFrames = 300;
+static uint32_t ScenarioWarmup = 120;//!< Frames rendered before timing, once the tox shows its output.
+static const uint32_t ScenarioWidth = 1920;
+static const uint32_t ScenarioHeight = 1080;
+
+// The float parameters a host would automate. The plugin shows TouchEngine parameters in its
+// Parameter<N> and Color slots, its own controls are named after what they do.
+static std::vector<FFUInt32> GetAutomatedSlots(FF_Main_FuncPtr plugMain, FFInstanceID instance) {
+	std::vector<FFUInt32> slots;
+	FFMixed input;
+	input.UIntValue = 0;
+	FFUInt32 count = plugMain(FF_GET_NUM_PARAMETERS, input, nullptr).UIntValue;
+	for (FFUInt32 slot = 0; slot < count; slot++) {
+		input.UIntValue = slot;
+		FFUInt32 type = plugMain(FF_GET_PARAMETER_TYPE, input, nullptr).UIntValue;
+		const char* name = static_cast<const char*>(plugMain(FF_GET_PARAMETER_NAME, input, nullptr).PointerValue);
+		bool isFloat = type == FF_TYPE_STANDARD || type == FF_TYPE_RED || type == FF_TYPE_GREEN || type == FF_TYPE_BLUE || type == FF_TYPE_ALPHA;
+		bool isTouchEngine = name != nullptr && (strncmp(name, "Parameter", 9) == 0 || strcmp(name, "Color") == 0);
+		if (isFloat && isTouchEngine && plugMain(FF_GET_PRAMETER_VISIBILITY, input, instance).UIntValue != 0) {
+			slots.push_back(slot);
+		}
+	}
+	return slots;
+}
+
+// True once the plugin has drawn into the middle of the target
+static bool HasOutput(const HostTarget& target) {
+	uint8_t pixel[4] = {};
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, target.Framebuffer);
+	glReadPixels(target.Width / 2, target.Height / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+	return (pixel[0] | pixel[1] | pixel[2] | pixel[3]) != 0;
+}
+
+// What a host does with a layer every frame: write each parameter that has automation on
+// it, read them back for its UI, render the layer and collect its parameter events. A frame
+// ends when the GPU is done with it.
+static bool RunScenarioSuite() {
+	FF_Main_FuncPtr generator = LoadPlugin(GENERATOR_PLUGIN_PATH);
+	FF_Main_FuncPtr effect = LoadPlugin(EFFECT_PLUGIN_PATH);
+	if (generator == nullptr || effect == nullptr) {
+		printf("Failed to load %s or %s\n", GENERATOR_PLUGIN_PATH, EFFECT_PLUGIN_PATH);
+		return false;
+	}
+
+	FFMixed none;
+	none.PointerValue = nullptr;
+	if (generator(FF_INITIALISE_V2, none, nullptr).UIntValue != FF_SUCCESS || effect(FF_INITIALISE_V2, none, nullptr).UIntValue != FF_SUCCESS) {
+		printf("Failed to initialise the plugins\n");
+		return false;
+	}
+
+	printf("%-33s %-18s %-28s %6s %8s %9s %9s %11s %14s %13s\n", "Scenario", "Shape", "Output", "Params",
+		"Cook ms", "Frame ms", "p99 ms", "Process ms", "Host ns/frame", "allocs/frame");
+
+	std::map<uint64_t, FFGLTextureStruct> inputs;
+	FFGLTextureStruct* inputTexture = GetInputTexture(inputs, ScenarioWidth, ScenarioHeight);
+	std::vector<ParamEventStruct> events(512);
+
+	for (const StubToxShape& shape : StubToxShapes) {
+		FF_Main_FuncPtr plugMain = shape.Input ? effect : generator;
+		std::string tox = std::string(EXAMPLE_DIRECTORY) + "/" + shape.Stem + ".tox";
+
+		FFGLViewportStruct viewport = { 0, 0, ScenarioWidth, ScenarioHeight };
+		FFMixed input;
+		input.PointerValue = &viewport;
+		FFInstanceID instance = plugMain(FF_INSTANTIATE_GL, input, nullptr).PointerValue;
+		if (instance == nullptr || instance == (void*)(uintptr_t)FF_FAIL) {
+			printf("%-33s failed to instantiate\n", shape.Stem);
+			continue;
+		}
+
+		SetParameterStruct parameter;
+		parameter.ParameterNumber = 0;
+		parameter.NewParameterValue.PointerValue = const_cast<char*>(tox.c_str());
+		input.PointerValue = &parameter;
+		plugMain(FF_SET_PARAMETER, input, instance);
+
+		HostTarget target;
+		ResizeTarget(target, ScenarioWidth, ScenarioHeight);
+		FFGLTextureStruct* textures[] = { inputTexture };
+		ProcessOpenGLStruct process;
+		process.numInputTextures = shape.Input ? 1 : 0;
+		process.inputTextures = textures;
+		process.HostFBO = target.Framebuffer;
+
+		std::vector<FFUInt32> slots;
+		std::vector<double> frameTimes;
+		double processMs = 0.0;
+		double hostNs = 0.0;
+		uint64_t allocations = 0;
+		auto renderFrame = [&](uint32_t frame, bool timed) {
+			auto frameStart = std::chrono::steady_clock::now();
+			uint64_t frameAllocations = Allocations.load();
+			float value = static_cast<float>(frame & 0xff) / 255.0f;
+			for (FFUInt32 slot : slots) {
+				parameter.ParameterNumber = slot;
+				memcpy(&parameter.NewParameterValue.UIntValue, &value, sizeof(value));
+				input.PointerValue = &parameter;
+				plugMain(FF_SET_PARAMETER, input, instance);
+			}
+			for (FFUInt32 slot : slots) {
+				input.UIntValue = slot;
+				plugMain(FF_GET_PARAMETER, input, instance);
+			}
+
+			auto processStart = std::chrono::steady_clock::now();
+			glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer);
+			glViewport(0, 0, target.Width, target.Height);
+			input.PointerValue = &process;
+			plugMain(FF_PROCESS_OPENGL, input, instance);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			auto processEnd = std::chrono::steady_clock::now();
+
+			GetParamEventsStruct buffer = { static_cast<FFUInt32>(events.size()), events.data() };
+			input.PointerValue = &buffer;
+			plugMain(FF_GET_PARAMETER_EVENTS, input, instance);
+			auto hostEnd = std::chrono::steady_clock::now();
+			frameAllocations = Allocations.load() - frameAllocations;
+			glFinish();
+
+			if (timed) {
+				frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+				processMs += std::chrono::duration<double, std::milli>(processEnd - processStart).count();
+				hostNs += std::chrono::duration<double, std::nano>((processStart - frameStart) + (hostEnd - processEnd)).count();
+				allocations += frameAllocations;
+			}
+		};
+
+		// Until the tox has loaded the plugin draws nothing and a frame costs next to nothing, so
+		// the warmup starts once its output shows up on the cleared target
+		glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		auto loadStart = std::chrono::steady_clock::now();
+		bool shown = false;
+		for (uint32_t frame = 0; !shown && std::chrono::steady_clock::now() - loadStart < std::chrono::seconds(10); frame++) {
+			renderFrame(frame, false);
+			shown = HasOutput(target);
+		}
+
+		if (shown) {
+			for (uint32_t frame = 0; frame < ScenarioWarmup; frame++) {
+				renderFrame(frame, false);
+			}
+			slots = GetAutomatedSlots(plugMain, instance);
+			for (uint32_t frame = 0; frame < ScenarioFrames; frame++) {
+				renderFrame(frame, true);
+			}
+		}
+
+		plugMain(FF_DEINSTANTIATE_GL, none, instance);
+		ReleaseTarget(target);
+		if (!shown) {
+			printf("%-33s no output after 10 s\n", shape.Stem);
+			continue;
+		}
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+		double frameMs = 0.0;
+		for (double time : frameTimes) {
+			frameMs += time;
+		}
+		frameMs /= frameTimes.size();
+		double p99Ms = frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 99 / 100)];
+
+		uint32_t outputWidth = shape.OutputWidth > 0 ? shape.OutputWidth : ScenarioWidth;
+		uint32_t outputHeight = shape.OutputHeight > 0 ? shape.OutputHeight : ScenarioHeight;
+		std::string output = std::string(shape.OutputFormat == StubOutputFormat::RGBA32F ? "RGBA 32-bit float " : "RGBA 8-bit ") +
+			std::to_string(outputWidth) + "x" + std::to_string(outputHeight);
+		printf("%-33s %-18s %-28s %6zu %8.2f %9.3f %9.3f %11.3f %14.1f %13.2f\n", shape.Stem, shape.Shape, output.c_str(), slots.size(),
+			shape.CookMs, frameMs, p99Ms, processMs / ScenarioFrames, hostNs / ScenarioFrames, static_cast<double>(allocations) / ScenarioFrames);
+	}
+
+	ReleaseInputTextures(inputs);
+	generator(FF_DEINITIALISE, none, nullptr);
+	effect(FF_DEINITIALISE, none, nullptr);
+	return true;
+}
+
+int main(int argc, char** argv) {
+	bool runSynthetic = true;
+	bool runScenarios = true;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--time") == 0 && i + 1 < argc) {
+			BenchmarkTimeNs = atoll(argv[++i]) * 1000000LL;
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			ScenarioFrames = std::max(static_cast<uint32_t>(atoi(argv[++i])), 1u);
+		} else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+			ScenarioWarmup = static_cast<uint32_t>(atoi(argv[++i]));
+		} else if (strcmp(argv[i], "--suite") == 0 && i + 1 < argc) {
+			const char* suite = argv[++i];
+			runSynthetic = strcmp(suite, "synthetic") == 0;
+			runScenarios = strcmp(suite, "scenarios") == 0;
+			if (!runSynthetic && !runScenarios) {
+				printf("Unknown suite %s, expected synthetic or scenarios\n", suite);
+				return 1;
+			}
+		}
+	}
+
+	// Both suites load tox files, the plugins' graphics devices are created on this context
+	if (!CreateGLContext()) {
+		printf("Failed to create an OpenGL context\n");
+		return 1;
+	}
+
+	FFMixed none;
+	none.UIntValue = 0;
+	if (CallPlugMain(FF_INITIALISE_V2, none, nullptr).UIntValue != FF_SUCCESS) {
+		printf("Failed to initialise the plugin library\n");
+		return 1;
+	}
+
+	bool syntheticRan = !runSynthetic || RunSyntheticSuite();
+	if (runSynthetic && runScenarios) {
+		printf("\n");
+	}
+	bool scenariosRan = !runScenarios || RunScenarioSuite();
+
+	CallPlugMain(FF_DEINITIALISE, none, nullptr);
+	return syntheticRan && scenariosRan ? 0 : 1;
+}
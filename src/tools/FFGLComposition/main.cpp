@@ -0,0 +1,240 @@
+// Runs N instances of a plugin in one GL context and renders them every frame the way a
+// host renders the layers of a composition, for growing N. For each N it reports the
+// composition frame time, what each instance adds to it, and the memory and GL objects
+// held per instance, so per-instance costs that could be shared or pooled stand out.
+//
+// Usage: FFGLComposition <plugin binary> [--tox <file>] [--instances 1,2,4,8,16]
+//                        [--frames 300] [--warmup 120] [--size 1920x1080]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FFGL/ffgl/FFGL.h"
+#include "HeadlessHost.h"
+
+struct Layer {
+	FFInstanceID Instance = nullptr;
+	HostTarget Target;
+};
+
+struct CompositionOptions {
+	std::string Tox;
+	std::vector<uint32_t> Instances = { 1, 2, 4, 8, 16 };
+	uint32_t Frames = 300;
+	uint32_t Warmup = 120;//!< Frames rendered before timing, TouchEngine loads the tox in the background.
+	uint32_t Width = 1920;
+	uint32_t Height = 1080;
+};
+
+static bool ParseOptions(int argc, char** argv, CompositionOptions& options) {
+	for (int i = 2; i < argc; i++) {
+		if (i + 1 >= argc) {
+			return false;
+		}
+		const char* flag = argv[i];
+		const char* value = argv[++i];
+		if (strcmp(flag, "--tox") == 0) {
+			options.Tox = value;
+		} else if (strcmp(flag, "--instances") == 0) {
+			options.Instances.clear();
+			for (const char* next = value; *next != '\0';) {
+				char* end = nullptr;
+				uint32_t count = static_cast<uint32_t>(strtoul(next, &end, 10));
+				if (end == next || count == 0) {
+					return false;
+				}
+				options.Instances.push_back(count);
+				next = *end == ',' ? end + 1 : end;
+			}
+		} else if (strcmp(flag, "--frames") == 0) {
+			options.Frames = std::max(static_cast<uint32_t>(atoi(value)), 1u);
+		} else if (strcmp(flag, "--warmup") == 0) {
+			options.Warmup = static_cast<uint32_t>(atoi(value));
+		} else if (strcmp(flag, "--size") == 0) {
+			if (sscanf(value, "%ux%u", &options.Width, &options.Height) != 2) {
+				return false;
+			}
+		} else {
+			return false;
+		}
+	}
+	return !options.Instances.empty();
+}
+
+static uint32_t GetInputCount(FF_Main_FuncPtr plugMain) {
+	FFMixed input;
+	input.PointerValue = nullptr;
+	const PluginInfoStruct* info = static_cast<const PluginInfoStruct*>(plugMain(FF_GET_INFO, input, nullptr).PointerValue);
+	if (info == nullptr || info->PluginType == FF_SOURCE) {
+		return 0;
+	}
+	return info->PluginType == FF_MIXER ? 2 : 1;
+}
+
+static FFInstanceID Instantiate(FF_Main_FuncPtr plugMain, const CompositionOptions& options) {
+	FFGLViewportStruct viewport = { 0, 0, options.Width, options.Height };
+	FFMixed input;
+	input.PointerValue = &viewport;
+	FFMixed result = plugMain(FF_INSTANTIATE_GL, input, nullptr);
+	if (result.PointerValue == nullptr || result.PointerValue == (void*)(uintptr_t)FF_FAIL) {
+		return nullptr;
+	}
+
+	if (!options.Tox.empty()) {
+		SetParameterStruct parameter;
+		parameter.ParameterNumber = 0;
+		parameter.NewParameterValue.PointerValue = const_cast<char*>(options.Tox.c_str());
+		input.PointerValue = &parameter;
+		plugMain(FF_SET_PARAMETER, input, result.PointerValue);
+	}
+	return result.PointerValue;
+}
+
+// Renders every layer once, returns the time each ProcessOpenGL call took in 'layerTimes'
+static void RenderFrame(FF_Main_FuncPtr plugMain, std::vector<Layer>& layers, FFGLTextureStruct* inputTexture, uint32_t numInputs,
+	std::vector<ParamEventStruct>& events, std::vector<double>& layerTimes) {
+	FFGLTextureStruct* textures[2] = { inputTexture, inputTexture };
+	layerTimes.clear();
+
+	for (auto& layer : layers) {
+		ProcessOpenGLStruct process;
+		process.numInputTextures = numInputs;
+		process.inputTextures = textures;
+		process.HostFBO = layer.Target.Framebuffer;
+
+		FFMixed input;
+		input.PointerValue = &process;
+		glBindFramebuffer(GL_FRAMEBUFFER, layer.Target.Framebuffer);
+		glViewport(0, 0, layer.Target.Width, layer.Target.Height);
+		auto start = std::chrono::steady_clock::now();
+		plugMain(FF_PROCESS_OPENGL, input, layer.Instance);
+		layerTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		// Hosts drain the parameter events of every layer each frame
+		GetParamEventsStruct buffer = { static_cast<FFUInt32>(events.size()), events.data() };
+		input.PointerValue = &buffer;
+		plugMain(FF_GET_PARAMETER_EVENTS, input, layer.Instance);
+	}
+}
+
+int main(int argc, char** argv) {
+	CompositionOptions options;
+	if (argc < 2 || !ParseOptions(argc, argv, options)) {
+		printf("Usage: FFGLComposition <plugin binary> [--tox <file>] [--instances 1,2,4,8,16] [--frames 300] [--warmup 120] [--size 1920x1080]\n");
+		return 1;
+	}
+
+	if (!CreateGLContext()) {
+		printf("Failed to create an OpenGL context\n");
+		return 1;
+	}
+
+	FF_Main_FuncPtr plugMain = LoadPlugin(argv[1]);
+	if (plugMain == nullptr) {
+		printf("Failed to load plugin %s\n", argv[1]);
+		return 1;
+	}
+
+	FFMixed none;
+	none.PointerValue = nullptr;
+	if (plugMain(FF_INITIALISE_V2, none, nullptr).UIntValue != FF_SUCCESS) {
+		printf("Failed to initialise plugin %s\n", argv[1]);
+		return 1;
+	}
+
+	uint32_t numInputs = GetInputCount(plugMain);
+	std::map<uint64_t, FFGLTextureStruct> inputs;
+	FFGLTextureStruct* inputTexture = GetInputTexture(inputs, options.Width, options.Height);
+	std::vector<ParamEventStruct> events(512);
+	std::vector<double> layerTimes;
+
+	printf("%9s %14s %13s %12s %12s %13s %13s %11s %9s %9s %9s %9s\n", "Instances", "Instantiate ms", "Frame ms", "p99 ms",
+		"ms/instance", "Process ms", "Added ms", "MB/instance", "Textures", "Buffers", "FBOs", "Programs");
+
+	double previousFrameMs = 0.0;
+	uint32_t previousCount = 0;
+	for (uint32_t count : options.Instances) {
+		glFinish();
+		size_t memoryBefore = GetResidentMemory();
+		GLObjectCounts objectsBefore = CountGLObjects();
+
+		std::vector<Layer> layers(count);
+		auto instantiateStart = std::chrono::steady_clock::now();
+		bool failed = false;
+		for (auto& layer : layers) {
+			layer.Instance = Instantiate(plugMain, options);
+			failed |= layer.Instance == nullptr;
+			ResizeTarget(layer.Target, options.Width, options.Height);
+		}
+		double instantiateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - instantiateStart).count();
+		if (failed) {
+			printf("Failed to instantiate %u instances\n", count);
+			for (auto& layer : layers) {
+				if (layer.Instance != nullptr) {
+					plugMain(FF_DEINSTANTIATE_GL, none, layer.Instance);
+				}
+				ReleaseTarget(layer.Target);
+			}
+			break;
+		}
+
+		for (uint32_t frame = 0; frame < options.Warmup; frame++) {
+			RenderFrame(plugMain, layers, inputTexture, numInputs, events, layerTimes);
+			glFinish();
+		}
+
+		// A frame ends when the GPU is done with every layer, like a host presenting the composition
+		std::vector<double> frameTimes;
+		double processMs = 0.0;
+		for (uint32_t frame = 0; frame < options.Frames; frame++) {
+			auto frameStart = std::chrono::steady_clock::now();
+			RenderFrame(plugMain, layers, inputTexture, numInputs, events, layerTimes);
+			glFinish();
+			frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+			for (double time : layerTimes) {
+				processMs += time;
+			}
+		}
+
+		size_t memoryAfter = GetResidentMemory();
+		GLObjectCounts objectsAfter = CountGLObjects();
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+		double frameMs = 0.0;
+		for (double time : frameTimes) {
+			frameMs += time;
+		}
+		frameMs /= frameTimes.size();
+		double p99Ms = frameTimes[std::min(frameTimes.size() - 1, frameTimes.size() * 99 / 100)];
+		// Cost of each instance added since the previous row
+		double addedMs = previousCount < count ? (frameMs - previousFrameMs) / (count - previousCount) : 0.0;
+		double memoryMb = memoryAfter > memoryBefore ? (memoryAfter - memoryBefore) / (1024.0 * 1024.0) / count : 0.0;
+
+		// Objects of the host targets are not the plugin's
+		auto perInstance = [count](uint32_t after, uint32_t before, uint32_t host) {
+			return (static_cast<double>(after) - before - host * count) / count;
+		};
+		printf("%9u %14.1f %13.3f %12.3f %12.3f %13.3f %13.3f %11.1f %9.1f %9.1f %9.1f %9.1f\n", count, instantiateMs, frameMs, p99Ms,
+			frameMs / count, processMs / options.Frames / count, addedMs, memoryMb,
+			perInstance(objectsAfter.Textures, objectsBefore.Textures, 1), perInstance(objectsAfter.Buffers, objectsBefore.Buffers, 0),
+			perInstance(objectsAfter.Framebuffers, objectsBefore.Framebuffers, 1), perInstance(objectsAfter.Programs, objectsBefore.Programs, 0));
+
+		for (auto& layer : layers) {
+			plugMain(FF_DEINSTANTIATE_GL, none, layer.Instance);
+			ReleaseTarget(layer.Target);
+		}
+		previousFrameMs = frameMs;
+		previousCount = count;
+	}
+
+	ReleaseInputTextures(inputs);
+	plugMain(FF_DEINITIALISE, none, nullptr);
+	return 0;
+}
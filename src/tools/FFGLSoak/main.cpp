@@ -0,0 +1,322 @@
+// Loads and unloads a plugin instance thousands of times, the way a show does when layers
+// and clips are swapped: instantiate, load a tox, render while parameters change, resize,
+// reload, unload and deinstantiate. After every cycle it records the resident memory, the
+// live GL objects and how long the cycle took, and fails when any of them keeps growing.
+//
+// Usage: FFGLSoak <plugin binary> <tox> [--cycles 1000] [--frames 120] [--warmup 20]
+//                 [--max-growth-mb 32] [--max-gl-growth 0] [--max-slowdown 2] [--size 1920x1080]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "FFGL/ffgl/FFGL.h"
+#include "HeadlessHost.h"
+
+// Event parameters every TouchEngine plugin exposes, see ConstructBaseParameters
+static const FFUInt32 ParamTox = 0;
+static const FFUInt32 ParamReload = 1;
+static const FFUInt32 ParamUnload = 2;
+static const FFUInt32 ParamClearInstance = 3;
+
+struct SoakOptions {
+	std::string Tox;
+	uint32_t Cycles = 1000;
+	uint32_t Frames = 120;//!< Frames rendered per cycle, TouchEngine loads the tox in the background.
+	uint32_t Warmup = 20;//!< Cycles run before the baseline is taken, caches and pools fill up in them.
+	double MaxGrowthMb = 32.0;
+	int64_t MaxGLGrowth = 0;
+	double MaxSlowdown = 2.0;//!< Allowed ratio of the last cycles' mean time to the first ones'.
+	uint32_t Width = 1920;
+	uint32_t Height = 1080;
+};
+
+struct CycleSample {
+	double Ms = 0.0;
+	double InstantiateMs = 0.0;
+	double DeinstantiateMs = 0.0;
+	size_t Memory = 0;
+	uint32_t GLObjects = 0;
+};
+
+static bool ParseOptions(int argc, char** argv, SoakOptions& options) {
+	options.Tox = argv[2];
+	for (int i = 3; i < argc; i++) {
+		if (i + 1 >= argc) {
+			return false;
+		}
+		const char* flag = argv[i];
+		const char* value = argv[++i];
+		if (strcmp(flag, "--cycles") == 0) {
+			options.Cycles = std::max(static_cast<uint32_t>(atoi(value)), 1u);
+		} else if (strcmp(flag, "--frames") == 0) {
+			options.Frames = std::max(static_cast<uint32_t>(atoi(value)), 2u);
+		} else if (strcmp(flag, "--warmup") == 0) {
+			options.Warmup = static_cast<uint32_t>(atoi(value));
+		} else if (strcmp(flag, "--max-growth-mb") == 0) {
+			options.MaxGrowthMb = atof(value);
+		} else if (strcmp(flag, "--max-gl-growth") == 0) {
+			options.MaxGLGrowth = atoll(value);
+		} else if (strcmp(flag, "--max-slowdown") == 0) {
+			options.MaxSlowdown = atof(value);
+		} else if (strcmp(flag, "--size") == 0) {
+			if (sscanf(value, "%ux%u", &options.Width, &options.Height) != 2) {
+				return false;
+			}
+		} else {
+			return false;
+		}
+	}
+	// The baseline needs cycles after it to compare against
+	return options.Warmup < options.Cycles;
+}
+
+static uint32_t GetInputCount(FF_Main_FuncPtr plugMain) {
+	FFMixed input;
+	input.PointerValue = nullptr;
+	const PluginInfoStruct* info = static_cast<const PluginInfoStruct*>(plugMain(FF_GET_INFO, input, nullptr).PointerValue);
+	if (info == nullptr || info->PluginType == FF_SOURCE) {
+		return 0;
+	}
+	return info->PluginType == FF_MIXER ? 2 : 1;
+}
+
+// Float parameters the churn writes to, the tox's own parameters among them
+static std::vector<FFUInt32> GetStandardParameters(FF_Main_FuncPtr plugMain) {
+	std::vector<FFUInt32> parameters;
+	FFMixed input;
+	input.PointerValue = nullptr;
+	FFUInt32 count = plugMain(FF_GET_NUM_PARAMETERS, input, nullptr).UIntValue;
+	for (FFUInt32 i = 0; i < count; i++) {
+		input.UIntValue = i;
+		if (plugMain(FF_GET_PARAMETER_TYPE, input, nullptr).UIntValue == FF_TYPE_STANDARD) {
+			parameters.push_back(i);
+		}
+	}
+	return parameters;
+}
+
+static void SetFloat(FF_Main_FuncPtr plugMain, FFInstanceID instance, FFUInt32 index, float value) {
+	SetParameterStruct parameter;
+	parameter.ParameterNumber = index;
+	memcpy(&parameter.NewParameterValue.UIntValue, &value, sizeof(value));
+	FFMixed input;
+	input.PointerValue = &parameter;
+	plugMain(FF_SET_PARAMETER, input, instance);
+}
+
+static void FireEvent(FF_Main_FuncPtr plugMain, FFInstanceID instance, FFUInt32 index) {
+	SetFloat(plugMain, instance, index, 1.0f);
+	SetFloat(plugMain, instance, index, 0.0f);
+}
+
+static void Resize(FF_Main_FuncPtr plugMain, FFInstanceID instance, HostTarget& target, uint32_t width, uint32_t height) {
+	FFGLViewportStruct viewport = { 0, 0, width, height };
+	FFMixed input;
+	input.PointerValue = &viewport;
+	plugMain(FF_RESIZE, input, instance);
+	ResizeTarget(target, width, height);
+}
+
+static void RenderFrame(FF_Main_FuncPtr plugMain, FFInstanceID instance, HostTarget& target, FFGLTextureStruct* inputTexture,
+	uint32_t numInputs, std::vector<ParamEventStruct>& events) {
+	FFGLTextureStruct* textures[2] = { inputTexture, inputTexture };
+	ProcessOpenGLStruct process;
+	process.numInputTextures = numInputs;
+	process.inputTextures = textures;
+	process.HostFBO = target.Framebuffer;
+
+	FFMixed input;
+	input.PointerValue = &process;
+	glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer);
+	glViewport(0, 0, target.Width, target.Height);
+	plugMain(FF_PROCESS_OPENGL, input, instance);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	GetParamEventsStruct buffer = { static_cast<FFUInt32>(events.size()), events.data() };
+	input.PointerValue = &buffer;
+	plugMain(FF_GET_PARAMETER_EVENTS, input, instance);
+}
+
+// Least squares slope of 'values' over the cycle index
+static double GetSlope(const std::vector<double>& values) {
+	double n = static_cast<double>(values.size());
+	double sumX = 0.0, sumY = 0.0, sumXY = 0.0, sumXX = 0.0;
+	for (size_t i = 0; i < values.size(); i++) {
+		sumX += i;
+		sumY += values[i];
+		sumXY += i * values[i];
+		sumXX += static_cast<double>(i) * i;
+	}
+	double denominator = n * sumXX - sumX * sumX;
+	return denominator != 0.0 ? (n * sumXY - sumX * sumY) / denominator : 0.0;
+}
+
+static void PrintLatency(const char* label, std::vector<double> times) {
+	std::sort(times.begin(), times.end());
+	double total = 0.0;
+	for (double time : times) {
+		total += time;
+	}
+	printf("%-16s mean %9.3f ms  p50 %9.3f ms  p99 %9.3f ms  max %9.3f ms\n", label, total / times.size(),
+		times[times.size() / 2], times[std::min(times.size() - 1, times.size() * 99 / 100)], times.back());
+}
+
+int main(int argc, char** argv) {
+	SoakOptions options;
+	if (argc < 3 || !ParseOptions(argc, argv, options)) {
+		printf("Usage: FFGLSoak <plugin binary> <tox> [--cycles 1000] [--frames 120] [--warmup 20] [--max-growth-mb 32] [--max-gl-growth 0] [--max-slowdown 2] [--size 1920x1080]\n");
+		return 1;
+	}
+
+	if (!CreateGLContext()) {
+		printf("Failed to create an OpenGL context\n");
+		return 1;
+	}
+
+	FF_Main_FuncPtr plugMain = LoadPlugin(argv[1]);
+	if (plugMain == nullptr) {
+		printf("Failed to load plugin %s\n", argv[1]);
+		return 1;
+	}
+
+	FFMixed none;
+	none.PointerValue = nullptr;
+	if (plugMain(FF_INITIALISE_V2, none, nullptr).UIntValue != FF_SUCCESS) {
+		printf("Failed to initialise plugin %s\n", argv[1]);
+		return 1;
+	}
+
+	uint32_t numInputs = GetInputCount(plugMain);
+	std::vector<FFUInt32> parameters = GetStandardParameters(plugMain);
+	// Half size, so every resize changes the input, the output and the render target
+	uint32_t resizedWidth = std::max(options.Width / 2, 1u);
+	uint32_t resizedHeight = std::max(options.Height / 2, 1u);
+
+	std::map<uint64_t, FFGLTextureStruct> inputs;
+	GetInputTexture(inputs, options.Width, options.Height);
+	GetInputTexture(inputs, resizedWidth, resizedHeight);
+	std::vector<ParamEventStruct> events(512);
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> values(0.0f, 1.0f);
+
+	HostTarget target;
+	std::vector<CycleSample> samples;
+	samples.reserve(options.Cycles);
+	uint32_t reportInterval = std::max(options.Cycles / 20, 1u);
+
+	printf("%8s %12s %12s %12s %12s %10s\n", "Cycle", "Cycle ms", "Create ms", "Destroy ms", "RSS MB", "GL objects");
+	for (uint32_t cycle = 0; cycle < options.Cycles; cycle++) {
+		CycleSample sample;
+		auto cycleStart = std::chrono::steady_clock::now();
+
+		FFGLViewportStruct viewport = { 0, 0, options.Width, options.Height };
+		FFMixed input;
+		input.PointerValue = &viewport;
+		FFInstanceID instance = plugMain(FF_INSTANTIATE_GL, input, nullptr).PointerValue;
+		if (instance == nullptr || instance == (void*)(uintptr_t)FF_FAIL) {
+			printf("Failed to instantiate in cycle %u\n", cycle);
+			return 1;
+		}
+		SetParameterStruct tox;
+		tox.ParameterNumber = ParamTox;
+		tox.NewParameterValue.PointerValue = const_cast<char*>(options.Tox.c_str());
+		input.PointerValue = &tox;
+		plugMain(FF_SET_PARAMETER, input, instance);
+		ResizeTarget(target, options.Width, options.Height);
+		sample.InstantiateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cycleStart).count();
+
+		// First half at full size, second half resized, with a few parameters moving every frame
+		for (uint32_t frame = 0; frame < options.Frames; frame++) {
+			if (frame == options.Frames / 2) {
+				Resize(plugMain, instance, target, resizedWidth, resizedHeight);
+			}
+			for (uint32_t i = 0; i < 4 && !parameters.empty(); i++) {
+				SetFloat(plugMain, instance, parameters[random() % parameters.size()], values(random));
+			}
+			FFGLTextureStruct* inputTexture = GetInputTexture(inputs, target.Width, target.Height);
+			RenderFrame(plugMain, instance, target, inputTexture, numInputs, events);
+		}
+		FireEvent(plugMain, instance, ParamReload);
+		RenderFrame(plugMain, instance, target, GetInputTexture(inputs, target.Width, target.Height), numInputs, events);
+
+		// Every other cycle unloads explicitly, the rest leave it to the destructor
+		auto destroyStart = std::chrono::steady_clock::now();
+		if (cycle % 2 == 0) {
+			FireEvent(plugMain, instance, ParamUnload);
+			FireEvent(plugMain, instance, ParamClearInstance);
+		}
+		plugMain(FF_DEINSTANTIATE_GL, none, instance);
+		glFinish();
+		auto cycleEnd = std::chrono::steady_clock::now();
+		sample.DeinstantiateMs = std::chrono::duration<double, std::milli>(cycleEnd - destroyStart).count();
+		sample.Ms = std::chrono::duration<double, std::milli>(cycleEnd - cycleStart).count();
+
+		sample.Memory = GetResidentMemory();
+		sample.GLObjects = CountGLObjects().Total();
+		samples.push_back(sample);
+
+		if (cycle % reportInterval == 0 || cycle + 1 == options.Cycles) {
+			printf("%8u %12.3f %12.3f %12.3f %12.1f %10u\n", cycle, sample.Ms, sample.InstantiateMs, sample.DeinstantiateMs,
+				sample.Memory / (1024.0 * 1024.0), sample.GLObjects);
+		}
+	}
+
+	ReleaseTarget(target);
+	ReleaseInputTextures(inputs);
+	plugMain(FF_DEINITIALISE, none, nullptr);
+
+	// Growth is measured from the end of the warmup, the first cycles fill caches and pools
+	const CycleSample& baseline = samples[options.Warmup];
+	const CycleSample& last = samples.back();
+	double growthMb = (static_cast<double>(last.Memory) - baseline.Memory) / (1024.0 * 1024.0);
+	int64_t glGrowth = static_cast<int64_t>(last.GLObjects) - baseline.GLObjects;
+
+	std::vector<double> cycleTimes, instantiateTimes, deinstantiateTimes, memory;
+	for (uint32_t i = options.Warmup; i < samples.size(); i++) {
+		cycleTimes.push_back(samples[i].Ms);
+		instantiateTimes.push_back(samples[i].InstantiateMs);
+		deinstantiateTimes.push_back(samples[i].DeinstantiateMs);
+		memory.push_back(samples[i].Memory / (1024.0 * 1024.0));
+	}
+	// Mean of the first and last tenth of the cycles after the warmup
+	size_t window = std::max<size_t>(cycleTimes.size() / 10, 1);
+	double firstMs = 0.0, lastMs = 0.0;
+	for (size_t i = 0; i < window; i++) {
+		firstMs += cycleTimes[i] / window;
+		lastMs += cycleTimes[cycleTimes.size() - window + i] / window;
+	}
+	double slowdown = firstMs > 0.0 ? lastMs / firstMs : 1.0;
+
+	printf("\n");
+	PrintLatency("Cycle", cycleTimes);
+	PrintLatency("Instantiate", instantiateTimes);
+	PrintLatency("Deinstantiate", deinstantiateTimes);
+	printf("RSS growth       %.1f MB after %zu cycles, %.3f MB per 1000 cycles\n", growthMb, cycleTimes.size(), GetSlope(memory) * 1000.0);
+	printf("GL object growth %lld\n", static_cast<long long>(glGrowth));
+	printf("Cycle time       %.3f ms first, %.3f ms last, x%.2f\n", firstMs, lastMs, slowdown);
+
+	bool failed = false;
+	if (growthMb > options.MaxGrowthMb) {
+		printf("FAIL: resident memory grew by %.1f MB, more than %.1f MB\n", growthMb, options.MaxGrowthMb);
+		failed = true;
+	}
+	if (glGrowth > options.MaxGLGrowth) {
+		printf("FAIL: %lld GL objects leaked, more than %lld\n", static_cast<long long>(glGrowth), static_cast<long long>(options.MaxGLGrowth));
+		failed = true;
+	}
+	if (slowdown > options.MaxSlowdown) {
+		printf("FAIL: cycles got %.2f times slower, more than %.2f\n", slowdown, options.MaxSlowdown);
+		failed = true;
+	}
+	if (!failed) {
+		printf("PASS\n");
+	}
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+// Replays a host call trace recorded with FFGL_TRACE into a plugin, either at the
+// original pace or as fast as possible, and reports the ProcessOpenGL frame times of
+// the replay next to the recorded ones so two builds can be compared on the same show.
+//
+// Usage: FFGLTraceReplay <plugin binary> <trace file> [--max-speed]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FFGL/ffgl/FFGL.h"
+#include "FFGL/ffgl/FFGLTrace.h"
+#include "HeadlessHost.h"
+
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		printf("Usage: FFGLTraceReplay <plugin binary> <trace file> [--max-speed]\n");
+		return 1;
+	}
+	bool maxSpeed = argc > 3 && strcmp(argv[3], "--max-speed") == 0;
+
+	if (!CreateGLContext()) {
+		printf("Failed to create an OpenGL context\n");
+		return 1;
+	}
+
+	FF_Main_FuncPtr plugMain = LoadPlugin(argv[1]);
+	if (plugMain == nullptr) {
+		printf("Failed to load plugin %s\n", argv[1]);
+		return 1;
+	}
+
+	FFGLTrace::Reader reader;
+	if (!reader.Open(argv[2])) {
+		printf("Failed to open trace %s\n", argv[2]);
+		return 1;
+	}
+
+	std::map<uint64_t, FFInstanceID> instances;
+	std::map<uint64_t, HostTarget> targets;
+	std::map<uint64_t, FFGLTextureStruct> inputs;
+	std::vector<ParamEventStruct> events(256);
+	std::vector<double> recordedTimes;
+	std::vector<double> replayTimes;
+
+	FFGLTrace::Record record;
+	std::string text;
+	auto start = std::chrono::steady_clock::now();
+
+	while (reader.Next(record, text)) {
+		if (!maxSpeed) {
+			std::this_thread::sleep_until(start + std::chrono::nanoseconds(record.time));
+		}
+
+		FFInstanceID instance = nullptr;
+		auto found = instances.find(record.instance);
+		if (found != instances.end()) {
+			instance = found->second;
+		}
+
+		FFMixed input;
+		input.PointerValue = nullptr;
+
+		switch (record.functionCode) {
+		case FF_INITIALISE_V2:
+		case FF_DEINITIALISE:
+			plugMain(record.functionCode, input, nullptr);
+			break;
+		case FF_INSTANTIATE_GL:
+		{
+			FFGLViewportStruct viewport = { 0, 0, record.width[0], record.height[0] };
+			input.PointerValue = &viewport;
+			FFMixed result = plugMain(FF_INSTANTIATE_GL, input, nullptr);
+			if (result.PointerValue != nullptr && result.PointerValue != (void*)(uintptr_t)FF_FAIL) {
+				instances[record.instance] = result.PointerValue;
+				ResizeTarget(targets[record.instance], record.width[0], record.height[0]);
+			}
+			break;
+		}
+		case FF_DEINSTANTIATE_GL:
+			if (instance != nullptr) {
+				plugMain(FF_DEINSTANTIATE_GL, input, instance);
+				instances.erase(record.instance);
+			}
+			break;
+		case FF_RESIZE:
+		{
+			if (instance == nullptr) {
+				break;
+			}
+			FFGLViewportStruct viewport = { 0, 0, record.width[0], record.height[0] };
+			input.PointerValue = &viewport;
+			plugMain(FF_RESIZE, input, instance);
+			ResizeTarget(targets[record.instance], record.width[0], record.height[0]);
+			break;
+		}
+		case FF_SET_PARAMETER:
+		{
+			if (instance == nullptr) {
+				break;
+			}
+			SetParameterStruct parameter;
+			parameter.ParameterNumber = record.index;
+			if (record.textLength > 0) {
+				parameter.NewParameterValue.PointerValue = &text[0];
+			} else {
+				parameter.NewParameterValue.UIntValue = record.value;
+			}
+			input.PointerValue = &parameter;
+			plugMain(FF_SET_PARAMETER, input, instance);
+			break;
+		}
+		case FF_SET_PARAMETER_ELEMENT_VALUE:
+		{
+			if (instance == nullptr) {
+				break;
+			}
+			SetParameterElementValueStruct element;
+			element.ParameterNumber = record.index;
+			element.ElementNumber = static_cast<FFUInt32>(record.number);
+			element.NewParameterValue.UIntValue = record.value;
+			input.PointerValue = &element;
+			plugMain(FF_SET_PARAMETER_ELEMENT_VALUE, input, instance);
+			break;
+		}
+		case FF_PROCESS_OPENGL:
+		{
+			if (instance == nullptr) {
+				break;
+			}
+			HostTarget& target = targets[record.instance];
+			FFGLTextureStruct* textures[FFGLTrace::MaxInputs] = {};
+			ProcessOpenGLStruct process;
+			process.numInputTextures = std::min(record.numInputs, FFGLTrace::MaxInputs);
+			process.inputTextures = textures;
+			process.HostFBO = target.Framebuffer;
+			for (uint32_t i = 0; i < process.numInputTextures; i++) {
+				textures[i] = GetInputTexture(inputs, std::max(record.width[i], 1u), std::max(record.height[i], 1u));
+			}
+			input.PointerValue = &process;
+
+			glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer);
+			glViewport(0, 0, target.Width, target.Height);
+			auto frameStart = std::chrono::steady_clock::now();
+			plugMain(FF_PROCESS_OPENGL, input, instance);
+			auto frameEnd = std::chrono::steady_clock::now();
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+			recordedTimes.push_back(record.duration / 1000000.0);
+			replayTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+			break;
+		}
+		case FF_SET_TIME:
+		{
+			if (instance == nullptr) {
+				break;
+			}
+			double time = record.number;
+			input.PointerValue = &time;
+			plugMain(FF_SET_TIME, input, instance);
+			break;
+		}
+		case FF_SET_BEATINFO:
+		{
+			if (instance == nullptr) {
+				break;
+			}
+			SetBeatinfoStruct beatInfo = { static_cast<float>(record.number), static_cast<float>(record.number2) };
+			input.PointerValue = &beatInfo;
+			plugMain(FF_SET_BEATINFO, input, instance);
+			break;
+		}
+		case FF_SET_HOSTINFO:
+		{
+			if (instance == nullptr) {
+				break;
+			}
+			text.push_back('\0');
+			SetHostinfoStruct hostInfo = { text.c_str(), text.c_str() + strlen(text.c_str()) + 1 };
+			input.PointerValue = &hostInfo;
+			plugMain(FF_SET_HOSTINFO, input, instance);
+			break;
+		}
+		case FF_SET_SAMPLERATE:
+		case FF_ENABLE_PLUGIN_CAP:
+			if (instance != nullptr) {
+				input.UIntValue = record.index;
+				plugMain(record.functionCode, input, instance);
+			}
+			break;
+		case FF_CONNECT:
+		case FF_DISCONNECT:
+			if (instance != nullptr) {
+				plugMain(record.functionCode, input, instance);
+			}
+			break;
+		case FF_GET_PARAMETER_EVENTS:
+		{
+			// Keeps the plugin's event queue drained like the host did
+			if (instance == nullptr) {
+				break;
+			}
+			GetParamEventsStruct buffer = { static_cast<FFUInt32>(events.size()), events.data() };
+			input.PointerValue = &buffer;
+			plugMain(FF_GET_PARAMETER_EVENTS, input, instance);
+			break;
+		}
+		default:
+			// Queries without side effects are not replayed
+			break;
+		}
+	}
+
+	for (auto& instance : instances) {
+		FFMixed input;
+		input.PointerValue = nullptr;
+		plugMain(FF_DEINSTANTIATE_GL, input, instance.second);
+	}
+
+	PrintFrameTimes("Recorded", recordedTimes);
+	PrintFrameTimes("Replayed", replayTimes);
+	return 0;
+}
@@ -0,0 +1,225 @@
+#include "HeadlessHost.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+#ifdef __APPLE__
+#include <OpenGL/OpenGL.h>
+#include <mach/mach.h>
+#elif !defined(_WIN32)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+void __stdcall HostLogCallback(char* message) {
+#else
+void HostLogCallback(char* message) {
+#endif
+	printf("[plugin] %s\n", message);
+}
+
+bool CreateGLContext() {
+#ifdef _WIN32
+	WNDCLASSA windowClass = {};
+	windowClass.lpfnWndProc = DefWindowProcA;
+	windowClass.hInstance = GetModuleHandleA(nullptr);
+	windowClass.lpszClassName = "FFGLHeadlessHost";
+	RegisterClassA(&windowClass);
+
+	HWND window = CreateWindowA("FFGLHeadlessHost", "FFGLHeadlessHost", WS_OVERLAPPEDWINDOW, 0, 0, 16, 16, nullptr, nullptr, windowClass.hInstance, nullptr);
+	HDC dc = GetDC(window);
+
+	PIXELFORMATDESCRIPTOR format = {};
+	format.nSize = sizeof(format);
+	format.nVersion = 1;
+	format.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+	format.iPixelType = PFD_TYPE_RGBA;
+	format.cColorBits = 32;
+	if (!SetPixelFormat(dc, ChoosePixelFormat(dc, &format), &format)) {
+		return false;
+	}
+
+	HGLRC context = wglCreateContext(dc);
+	if (context == nullptr || !wglMakeCurrent(dc, context)) {
+		return false;
+	}
+	return glewInit() == GLEW_OK;
+#elif defined(__APPLE__)
+	CGLPixelFormatAttribute attributes[] = {
+		kCGLPFAOpenGLProfile, (CGLPixelFormatAttribute)kCGLOGLPVersion_GL4_Core,
+		kCGLPFAAccelerated,
+		(CGLPixelFormatAttribute)0
+	};
+	CGLPixelFormatObj format = nullptr;
+	GLint count = 0;
+	CGLContextObj context = nullptr;
+	if (CGLChoosePixelFormat(attributes, &format, &count) != kCGLNoError || format == nullptr) {
+		return false;
+	}
+	CGLError error = CGLCreateContext(format, nullptr, &context);
+	CGLDestroyPixelFormat(format);
+	return error == kCGLNoError && CGLSetCurrentContext(context) == kCGLNoError;
+#else
+	// Surfaceless EGL needs neither a window nor a display server, the host renders to its own framebuffers
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	EGLDisplay display = getPlatformDisplay != nullptr ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) : EGL_NO_DISPLAY;
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+		return false;
+	}
+
+	const EGLint attributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLConfig config = nullptr;
+	EGLint count = 0;
+	if (!eglChooseConfig(display, attributes, &config, 1, &count) || count == 0 || !eglBindAPI(EGL_OPENGL_API)) {
+		return false;
+	}
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+	return context != EGL_NO_CONTEXT && eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+#endif
+}
+
+FF_Main_FuncPtr LoadPlugin(const std::string& path) {
+	FF_SetLogCallback_FuncPtr setLogCallback = nullptr;
+	FF_Main_FuncPtr plugMain = nullptr;
+#ifdef _WIN32
+	HMODULE module = LoadLibraryA(path.c_str());
+	if (module == nullptr) {
+		return nullptr;
+	}
+	setLogCallback = (FF_SetLogCallback_FuncPtr)GetProcAddress(module, "SetLogCallback");
+	plugMain = (FF_Main_FuncPtr)GetProcAddress(module, "plugMain");
+#else
+	void* module = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (module == nullptr) {
+		return nullptr;
+	}
+	setLogCallback = (FF_SetLogCallback_FuncPtr)dlsym(module, "SetLogCallback");
+	plugMain = (FF_Main_FuncPtr)dlsym(module, "plugMain");
+#endif
+	if (setLogCallback != nullptr) {
+		setLogCallback(HostLogCallback);
+	}
+	return plugMain;
+}
+
+void ResizeTarget(HostTarget& target, uint32_t width, uint32_t height) {
+	if (target.Framebuffer == 0) {
+		glGenFramebuffers(1, &target.Framebuffer);
+		glGenTextures(1, &target.Texture);
+	}
+	target.Width = std::max(width, 1u);
+	target.Height = std::max(height, 1u);
+
+	glBindTexture(GL_TEXTURE_2D, target.Texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, target.Width, target.Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, target.Framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.Texture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ReleaseTarget(HostTarget& target) {
+	if (target.Framebuffer != 0) {
+		glDeleteFramebuffers(1, &target.Framebuffer);
+		glDeleteTextures(1, &target.Texture);
+	}
+	target = HostTarget();
+}
+
+FFGLTextureStruct* GetInputTexture(std::map<uint64_t, FFGLTextureStruct>& inputs, uint32_t width, uint32_t height) {
+	uint64_t key = (uint64_t(width) << 32) | height;
+	auto it = inputs.find(key);
+	if (it != inputs.end()) {
+		return &it->second;
+	}
+
+	FFGLTextureStruct& texture = inputs[key];
+	texture.Width = texture.HardwareWidth = width;
+	texture.Height = texture.HardwareHeight = height;
+	glGenTextures(1, &texture.Handle);
+	glBindTexture(GL_TEXTURE_2D, texture.Handle);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return &texture;
+}
+
+void ReleaseInputTextures(std::map<uint64_t, FFGLTextureStruct>& inputs) {
+	for (auto& input : inputs) {
+		glDeleteTextures(1, &input.second.Handle);
+	}
+	inputs.clear();
+}
+
+GLObjectCounts CountGLObjects(GLuint maxName) {
+	GLObjectCounts counts;
+	for (GLuint name = 1; name <= maxName; name++) {
+		counts.Textures += glIsTexture(name) ? 1 : 0;
+		counts.Buffers += glIsBuffer(name) ? 1 : 0;
+		counts.Framebuffers += glIsFramebuffer(name) ? 1 : 0;
+		counts.VertexArrays += glIsVertexArray(name) ? 1 : 0;
+		counts.Programs += glIsProgram(name) ? 1 : 0;
+		counts.Shaders += glIsShader(name) ? 1 : 0;
+	}
+	return counts;
+}
+
+size_t GetResidentMemory() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters = {};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.WorkingSetSize;
+#elif defined(__APPLE__)
+	mach_task_basic_info_data_t info = {};
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS) {
+		return 0;
+	}
+	return info.resident_size;
+#else
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file == nullptr) {
+		return 0;
+	}
+	unsigned long long pages = 0;
+	unsigned long long resident = 0;
+	int read = fscanf(file, "%llu %llu", &pages, &resident);
+	fclose(file);
+	return read == 2 ? static_cast<size_t>(resident * sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
+
+void PrintFrameTimes(const char* label, std::vector<double>& times) {
+	if (times.empty()) {
+		printf("%s: no frames\n", label);
+		return;
+	}
+	std::sort(times.begin(), times.end());
+	double total = 0.0;
+	for (double time : times) {
+		total += time;
+	}
+	printf("%s: %zu frames, mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n", label, times.size(),
+		total / times.size(), times[times.size() / 2], times[std::min(times.size() - 1, times.size() * 99 / 100)], times.back());
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Minimal FFGL host used by the tools: a hidden GL context, plugin loading, render targets
+// standing in for host layers, and the process and GL resource counters the benchmarks
+// report. Only one GL context exists, every plugin instance renders on it.
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FFGL/ffgl/FFGL.h"
+
+struct HostTarget {
+	GLuint Framebuffer = 0;
+	GLuint Texture = 0;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+};
+
+// Live GL objects in the context, found by probing object names
+struct GLObjectCounts {
+	uint32_t Textures = 0;
+	uint32_t Buffers = 0;
+	uint32_t Framebuffers = 0;
+	uint32_t VertexArrays = 0;
+	uint32_t Programs = 0;
+	uint32_t Shaders = 0;
+
+	uint32_t Total() const { return Textures + Buffers + Framebuffers + VertexArrays + Programs + Shaders; }
+};
+
+#ifdef _WIN32
+void __stdcall HostLogCallback(char* message);
+#else
+void HostLogCallback(char* message);
+#endif
+
+bool CreateGLContext();
+// Loads the plugin binary and routes its log to stdout, nullptr on failure.
+FF_Main_FuncPtr LoadPlugin(const std::string& path);
+
+void ResizeTarget(HostTarget& target, uint32_t width, uint32_t height);
+void ReleaseTarget(HostTarget& target);
+
+// Input textures are shared by size, their content doesn't matter for timing
+FFGLTextureStruct* GetInputTexture(std::map<uint64_t, FFGLTextureStruct>& inputs, uint32_t width, uint32_t height);
+void ReleaseInputTextures(std::map<uint64_t, FFGLTextureStruct>& inputs);
+
+// Names are handed out from 1 upwards, so probing the first 'maxName' of them finds every
+// object a plugin is likely to hold. Slow, only call it between measurements.
+GLObjectCounts CountGLObjects(GLuint maxName = 16384);
+// Resident set size of this process in bytes, 0 when it can't be read.
+size_t GetResidentMemory();
+
+void PrintFrameTimes(const char* label, std::vector<double>& times);
@@ -0,0 +1,38 @@
+#pragma once
+
+// The tox files in Example/ as the stub loads them, found by file name without the extension.
+// The links are modelled on the file names, the stub can't read a tox, and the cook times are
+// typical of a small noise network at the output size. Shared with FFGLBenchmarks, which runs
+// its scenario suite over these files.
+
+#include <cstdint>
+
+enum class StubOutputFormat {
+	RGBA8,
+	RGBA32F,
+};
+
+struct StubToxShape {
+	const char* Stem;
+	const char* Shape;//!< Generator, FX, vector parameters, dropdown or 32-bit output.
+	bool Input;//!< Has the op/in1 TOP input.
+	int32_t Floats;//!< Float<N> parameters.
+	bool Vectors;//!< Translate (XYZ) and Color (RGBA) parameters.
+	bool Menu;//!< A Type menu with six choices.
+	StubOutputFormat OutputFormat;
+	int32_t OutputWidth;//!< Fixed output size, 0 follows the input.
+	int32_t OutputHeight;
+	double CookMs;//!< Time one frame takes to cook.
+};
+
+inline const StubToxShape StubToxShapes[] = {
+	{ "NoiseOutOnly", "Generator", false, 0, false, false, StubOutputFormat::RGBA8, 1920, 1080, 0.3 },
+	{ "NoiseOutOnly1Param", "Generator", false, 1, false, false, StubOutputFormat::RGBA8, 1920, 1080, 0.3 },
+	{ "NoiseOutOnly5Param", "Generator", false, 5, false, false, StubOutputFormat::RGBA8, 1920, 1080, 0.4 },
+	{ "NoiseOutOnly5ParamDropdown", "Dropdown", false, 4, false, true, StubOutputFormat::RGBA8, 1920, 1080, 0.4 },
+	{ "NoiseOutOnly32Bit", "32-bit output", false, 0, false, false, StubOutputFormat::RGBA32F, 1920, 1080, 0.8 },
+	{ "InputOutput5Param", "FX", true, 5, false, false, StubOutputFormat::RGBA8, 0, 0, 0.6 },
+	{ "InputOutput5ParamDifferentOutput", "FX", true, 5, false, false, StubOutputFormat::RGBA8, 1280, 720, 0.5 },
+	{ "InputOutput5ParamVector", "Vector parameters", true, 3, true, false, StubOutputFormat::RGBA8, 0, 0, 0.6 },
+	{ "SyphonTestInput", "FX", true, 0, false, false, StubOutputFormat::RGBA8, 0, 0, 0.3 },
+};
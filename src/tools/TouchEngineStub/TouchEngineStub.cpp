@@ -0,0 +1,1237 @@
+// In-process stand-in for the TouchEngine library on Linux, where Derivative ships none. It
+// implements the C API the plugins call with the same threading and ownership rules: every
+// instance has its own callback thread, objects are reference counted and released with
+// TERelease, and links and values behave like a loaded tox. No TouchDesigner process is
+// started. Textures are OpenGL textures, each cooked frame clears the texture outputs to a
+// new color on the host's context when the host reads them.
+//
+// The tox files in Example/ load with the links, output format, output size and cook time
+// listed for their name in StubToxShapes.h. Every other file that can be opened loads as:
+//   inputs   op/in1 (TOP), op/table1 (DAT), and under p/ the parameters Speed, Amplitude,
+//            Offset, Color (RGBA), Translate (XYZ), Steps, Mode (menu), Active, Reset (pulse)
+//            and Label
+//   outputs  op/out1 (TOP, RGBA 8-bit at the input's size), op/chop1 (CHOP, 2 channels),
+//            op/dat1 (DAT)
+// Both are read again on every load: TE_STUB_PARAMETERS adds that many Float<N> parameters,
+// TE_STUB_COOK_MS sets how long each frame takes to cook, by default the tox's own cook time
+// or 0.
+
+#include "TouchEngine/TouchEngine.h"
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "TouchEngine/TEOpenGL.h"
+#include "StubToxShapes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct StubObject {
+	std::atomic<int32_t> RefCount{ 1 };
+	TEObjectType Type = TEObjectTypeUnknown;
+
+	virtual ~StubObject() = default;
+};
+
+// Objects by the pointer the caller holds, which for the public structs is not the object itself
+static std::mutex ObjectsMutex;
+static std::unordered_map<const void*, StubObject*> Objects;
+
+template <typename T>
+static T* Track(StubObject* object, T* handle, TEObjectType type) {
+	object->Type = type;
+	std::lock_guard<std::mutex> lock(ObjectsMutex);
+	Objects[handle] = object;
+	return handle;
+}
+
+static StubObject* FindObject(const void* handle) {
+	std::lock_guard<std::mutex> lock(ObjectsMutex);
+	auto it = Objects.find(handle);
+	return it != Objects.end() ? it->second : nullptr;
+}
+
+struct StubString : StubObject {
+	std::string Text;
+	TEString Value;
+};
+
+struct StubStringArray : StubObject {
+	std::vector<std::string> Texts;
+	std::vector<const char*> Pointers;
+	TEStringArray Value;
+};
+
+struct StubLinkInfo : StubObject {
+	std::string Label;
+	std::string Name;
+	std::string Identifier;
+	TELinkInfo Value;
+};
+
+struct StubErrorArray : StubObject {
+	TEErrorArray Value = { 0, nullptr };
+};
+
+struct TETable_ : StubObject {
+	int32_t Rows = 0;
+	int32_t Columns = 0;
+	std::vector<std::string> Cells;
+};
+
+struct TEFloatBuffer_ : StubObject {
+	double Rate = -1.0;
+	bool TimeDependent = false;
+	uint32_t Capacity = 0;
+	uint32_t Count = 0;
+	int64_t StartTime = 0;
+	std::vector<std::string> Names;
+	std::vector<const char*> NamePointers;
+	std::vector<std::vector<float>> Channels;
+	std::vector<const float*> ChannelPointers;
+	TEFloatBufferExtend ExtendBefore = TEFloatBufferExtendHold;
+	TEFloatBufferExtend ExtendAfter = TEFloatBufferExtendHold;
+	float ExtendConstant = 0.0f;
+};
+
+struct TEOpenGLTexture_ : StubObject {
+	GLuint Name = 0;
+	GLenum Target = 0;
+	GLint InternalFormat = 0;
+	int32_t Width = 0;
+	int32_t Height = 0;
+	TETextureOrigin Origin = TETextureOriginBottomLeft;
+	TEOpenGLTextureCallback Callback = nullptr;
+	void* Info = nullptr;
+
+	~TEOpenGLTexture_() override {
+		if (Callback != nullptr) {
+			Callback(Name, TEObjectEventRelease, Info);
+		}
+	}
+};
+
+static TEString* CreateString(const std::string& text) {
+	StubString* object = new StubString();
+	object->Text = text;
+	object->Value.string = object->Text.c_str();
+	return Track(object, &object->Value, TEObjectTypeString);
+}
+
+static TEStringArray* CreateStringArray(const std::vector<std::string>& texts) {
+	StubStringArray* object = new StubStringArray();
+	object->Texts = texts;
+	for (const std::string& text : object->Texts) {
+		object->Pointers.push_back(text.c_str());
+	}
+	object->Value.count = static_cast<int32_t>(object->Pointers.size());
+	object->Value.strings = object->Pointers.data();
+	return Track(object, &object->Value, TEObjectTypeStringArray);
+}
+
+static TEFloatBuffer* CreateFloatBuffer(double rate, int32_t channels, uint32_t capacity, const char* const* names, bool timeDependent) {
+	if (channels <= 0) {
+		return nullptr;
+	}
+	TEFloatBuffer_* buffer = new TEFloatBuffer_();
+	buffer->Rate = rate;
+	buffer->TimeDependent = timeDependent;
+	buffer->Capacity = capacity;
+	buffer->Channels.assign(channels, std::vector<float>(capacity, 0.0f));
+	for (auto& channel : buffer->Channels) {
+		buffer->ChannelPointers.push_back(channel.data());
+	}
+	if (names != nullptr) {
+		for (int32_t i = 0; i < channels; i++) {
+			buffer->Names.push_back(names[i] != nullptr ? names[i] : "");
+		}
+		for (const std::string& name : buffer->Names) {
+			buffer->NamePointers.push_back(name.c_str());
+		}
+	}
+	return Track(buffer, buffer, TEObjectTypeFloatBuffer);
+}
+
+struct StubLink {
+	std::string Identifier;
+	std::string Name;
+	std::string Label;
+	TEScope Scope = TEScopeInput;
+	TELinkType Type = TELinkTypeDouble;
+	TELinkIntent Intent = TELinkIntentNotSpecified;
+	TELinkDomain Domain = TELinkDomainParameter;
+	std::vector<std::string> Children;//!< Links of a group.
+
+	// Booleans and ints are held as doubles
+	std::vector<double> Min;
+	std::vector<double> Max;
+	std::vector<double> Default;
+	std::vector<double> Value;
+	std::vector<std::string> Choices;
+	std::string Text;
+	TETable* Table = nullptr;
+	TEFloatBuffer* Buffer = nullptr;
+
+	int32_t GetCount() const {
+		return Type == TELinkTypeGroup ? static_cast<int32_t>(Children.size()) : std::max<int32_t>(1, static_cast<int32_t>(Value.size()));
+	}
+};
+
+// A texture output, made and cleared on the host's context when the host reads it
+struct StubOutputTexture {
+	GLuint Name = 0;
+	GLint Format = 0;
+	int32_t Width = 0;
+	int32_t Height = 0;
+	uint64_t Frame = 0;//!< Frame the texture was last cleared for.
+};
+
+struct TEInstance_ : StubObject {
+	TEInstanceEventCallback EventCallback = nullptr;
+	TEInstanceLinkCallback LinkCallback = nullptr;
+	TEInstanceStatisticsCallback StatisticsCallback = nullptr;
+	void* Info = nullptr;
+
+	// Guards everything below, never held while a callback runs
+	std::mutex Mutex;
+	std::string Path;
+	TETimeMode TimeMode = TETimeExternal;
+	bool Loaded = false;
+	bool Suspended = false;
+	bool FrameBusy = false;
+	int64_t RateNumerator = 60;
+	int32_t RateDenominator = 1;
+	TETextureOrigin OutputOrigin = TETextureOriginBottomLeft;
+	TEGraphicsContext* Context = nullptr;
+	std::vector<std::string> InputGroups;
+	std::vector<std::string> OutputGroups;
+	std::unordered_map<std::string, StubLink> Links;
+	uint64_t FramesCooked = 0;
+
+	// Set when the tox loads
+	double CookMs = 0.0;
+	GLint OutputFormat = GL_RGBA8;
+	int32_t OutputWidth = 0;//!< 0 follows the input.
+	int32_t OutputHeight = 0;
+	int32_t InputWidth = 0;
+	int32_t InputHeight = 0;
+	// Outlive the links, a reload on the callback thread can't release GL objects
+	std::unordered_map<std::string, StubOutputTexture> OutputTextures;
+
+	// Callbacks are delivered in order on this thread, like TouchEngine's own
+	std::thread Worker;
+	std::condition_variable Wake;
+	std::deque<std::function<void()>> Tasks;
+	bool Stopping = false;
+
+	void Post(std::function<void()> task) {
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			Tasks.push_back(std::move(task));
+		}
+		Wake.notify_one();
+	}
+
+	void Run() {
+		std::unique_lock<std::mutex> lock(Mutex);
+		while (true) {
+			Wake.wait(lock, [this] { return Stopping || !Tasks.empty(); });
+			if (Stopping) {
+				return;
+			}
+			std::function<void()> task = std::move(Tasks.front());
+			Tasks.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+		}
+	}
+
+	void SendEvent(TEEvent event, TEResult result, int64_t timeValue = 0, int32_t timeScale = 0) {
+		if (EventCallback != nullptr) {
+			EventCallback(this, event, result, timeValue, timeScale, timeValue, timeScale, Info);
+		}
+	}
+
+	void SendLinkEvent(TELinkEvent event, const std::string& identifier) {
+		if (LinkCallback != nullptr) {
+			LinkCallback(this, event, identifier.c_str(), Info);
+		}
+	}
+
+	~TEInstance_() override {
+		{
+			std::lock_guard<std::mutex> lock(Mutex);
+			Stopping = true;
+			Tasks.clear();
+		}
+		Wake.notify_one();
+		// The last reference can be dropped from inside a callback
+		if (Worker.get_id() == std::this_thread::get_id()) {
+			Worker.detach();
+		} else if (Worker.joinable()) {
+			Worker.join();
+		}
+		ClearLinks();
+		if (Context != nullptr) {
+			TERelease(&Context);
+		}
+		// Hosts release instances on their GL context. Without one current, the textures
+		// went with the context.
+		if (glGetString(GL_VERSION) != nullptr) {
+			for (auto& texture : OutputTextures) {
+				glDeleteTextures(1, &texture.second.Name);
+			}
+		}
+	}
+
+	void ClearLinks() {
+		for (auto& link : Links) {
+			if (link.second.Table != nullptr) {
+				TERelease(&link.second.Table);
+			}
+			if (link.second.Buffer != nullptr) {
+				TERelease(&link.second.Buffer);
+			}
+		}
+		Links.clear();
+		InputGroups.clear();
+		OutputGroups.clear();
+	}
+
+	StubLink* FindLink(const char* identifier) {
+		if (identifier == nullptr) {
+			return nullptr;
+		}
+		auto it = Links.find(identifier);
+		return it != Links.end() ? &it->second : nullptr;
+	}
+};
+
+static void AddLink(TEInstance_* instance, const std::string& group, StubLink link) {
+	instance->Links[group].Children.push_back(link.Identifier);
+	instance->Links[link.Identifier] = std::move(link);
+}
+
+static StubLink GroupLink(const std::string& identifier, TEScope scope, TELinkDomain domain) {
+	StubLink link;
+	link.Identifier = identifier;
+	link.Name = identifier;
+	link.Label = identifier;
+	link.Scope = scope;
+	link.Type = TELinkTypeGroup;
+	link.Domain = domain;
+	return link;
+}
+
+static StubLink OperatorLink(const std::string& name, TEScope scope, TELinkType type) {
+	StubLink link;
+	link.Identifier = "op/" + name;
+	link.Name = name;
+	link.Label = name;
+	link.Scope = scope;
+	link.Type = type;
+	link.Domain = TELinkDomainOperator;
+	return link;
+}
+
+static StubLink ValueLink(const std::string& name, TELinkType type, TELinkIntent intent, size_t count, double min, double max, double value) {
+	StubLink link;
+	link.Identifier = "p/" + name;
+	link.Name = name;
+	link.Label = name;
+	link.Type = type;
+	link.Intent = intent;
+	link.Min.assign(count, min);
+	link.Max.assign(count, max);
+	link.Default.assign(count, value);
+	link.Value = link.Default;
+	return link;
+}
+
+static void AddFloatParameters(TEInstance_* instance, int32_t first, int32_t count) {
+	for (int32_t i = first; i < first + count; i++) {
+		AddLink(instance, "p", ValueLink("Float" + std::to_string(i), TELinkTypeDouble, TELinkIntentNotSpecified, 1, 0.0, 1.0, 0.5));
+	}
+}
+
+// The links of a file not listed in StubToxShapes.h, see the top of the file
+static int32_t BuildDefaultLinks(TEInstance_* instance) {
+	instance->InputGroups = { "op", "p" };
+	instance->OutputGroups = { "op/outputs" };
+	instance->Links["op"] = GroupLink("op", TEScopeInput, TELinkDomainNone);
+	instance->Links["p"] = GroupLink("p", TEScopeInput, TELinkDomainParameterPage);
+	instance->Links["op/outputs"] = GroupLink("op/outputs", TEScopeOutput, TELinkDomainNone);
+
+	AddLink(instance, "op", OperatorLink("in1", TEScopeInput, TELinkTypeTexture));
+	StubLink tableIn = OperatorLink("table1", TEScopeInput, TELinkTypeStringData);
+	tableIn.Table = TETableCreate();
+	AddLink(instance, "op", std::move(tableIn));
+
+	AddLink(instance, "p", ValueLink("Speed", TELinkTypeDouble, TELinkIntentNotSpecified, 1, 0.0, 10.0, 1.0));
+	AddLink(instance, "p", ValueLink("Amplitude", TELinkTypeDouble, TELinkIntentNotSpecified, 1, 0.0, 1.0, 0.5));
+	AddLink(instance, "p", ValueLink("Offset", TELinkTypeDouble, TELinkIntentNotSpecified, 1, -1.0, 1.0, 0.0));
+	AddLink(instance, "p", ValueLink("Color", TELinkTypeDouble, TELinkIntentColorRGBA, 4, 0.0, 1.0, 1.0));
+	AddLink(instance, "p", ValueLink("Translate", TELinkTypeDouble, TELinkIntentPositionXYZW, 3, -10.0, 10.0, 0.0));
+	AddLink(instance, "p", ValueLink("Steps", TELinkTypeInt, TELinkIntentNotSpecified, 1, 1.0, 32.0, 8.0));
+	StubLink mode = ValueLink("Mode", TELinkTypeInt, TELinkIntentNotSpecified, 1, 0.0, 2.0, 0.0);
+	mode.Choices = { "Sine", "Square", "Noise" };
+	AddLink(instance, "p", std::move(mode));
+	AddLink(instance, "p", ValueLink("Active", TELinkTypeBoolean, TELinkIntentNotSpecified, 1, 0.0, 1.0, 1.0));
+	AddLink(instance, "p", ValueLink("Reset", TELinkTypeBoolean, TELinkIntentPulse, 1, 0.0, 1.0, 0.0));
+	StubLink label = ValueLink("Label", TELinkTypeString, TELinkIntentNotSpecified, 1, 0.0, 0.0, 0.0);
+	label.Text = "stub";
+	AddLink(instance, "p", std::move(label));
+
+	AddLink(instance, "op/outputs", OperatorLink("out1", TEScopeOutput, TELinkTypeTexture));
+	StubLink chop = OperatorLink("chop1", TEScopeOutput, TELinkTypeFloatBuffer);
+	const char* names[] = { "chan1", "chan2" };
+	chop.Buffer = CreateFloatBuffer(-1.0, 2, 1, names, false);
+	AddLink(instance, "op/outputs", std::move(chop));
+	StubLink tableOut = OperatorLink("dat1", TEScopeOutput, TELinkTypeStringData);
+	tableOut.Table = TETableCreate();
+	TETableResize(tableOut.Table, 2, 2);
+	AddLink(instance, "op/outputs", std::move(tableOut));
+
+	instance->OutputFormat = GL_RGBA8;
+	instance->OutputWidth = 0;
+	instance->OutputHeight = 0;
+	return 1;
+}
+
+// The links of an Example tox, returns the number of the next Float<N> parameter
+static int32_t BuildShapeLinks(TEInstance_* instance, const StubToxShape& shape) {
+	instance->InputGroups = { "p" };
+	instance->OutputGroups = { "op/outputs" };
+	instance->Links["p"] = GroupLink("p", TEScopeInput, TELinkDomainParameterPage);
+	instance->Links["op/outputs"] = GroupLink("op/outputs", TEScopeOutput, TELinkDomainNone);
+
+	if (shape.Input) {
+		instance->InputGroups.insert(instance->InputGroups.begin(), "op");
+		instance->Links["op"] = GroupLink("op", TEScopeInput, TELinkDomainNone);
+		AddLink(instance, "op", OperatorLink("in1", TEScopeInput, TELinkTypeTexture));
+	}
+
+	AddFloatParameters(instance, 1, shape.Floats);
+	if (shape.Vectors) {
+		AddLink(instance, "p", ValueLink("Translate", TELinkTypeDouble, TELinkIntentPositionXYZW, 3, -10.0, 10.0, 0.0));
+		AddLink(instance, "p", ValueLink("Color", TELinkTypeDouble, TELinkIntentColorRGBA, 4, 0.0, 1.0, 1.0));
+	}
+	if (shape.Menu) {
+		StubLink type = ValueLink("Type", TELinkTypeInt, TELinkIntentNotSpecified, 1, 0.0, 5.0, 0.0);
+		type.Choices = { "Sparse", "Hermite", "Harmonic Summation", "Brownian", "Random", "Alligator" };
+		AddLink(instance, "p", std::move(type));
+	}
+
+	AddLink(instance, "op/outputs", OperatorLink("out1", TEScopeOutput, TELinkTypeTexture));
+
+	instance->OutputFormat = shape.OutputFormat == StubOutputFormat::RGBA32F ? GL_RGBA32F : GL_RGBA8;
+	instance->OutputWidth = shape.OutputWidth;
+	instance->OutputHeight = shape.OutputHeight;
+	return shape.Floats + 1;
+}
+
+static const StubToxShape* FindShape(const std::string& path) {
+	size_t separator = path.find_last_of("/\\");
+	std::string stem = separator != std::string::npos ? path.substr(separator + 1) : path;
+	stem = stem.substr(0, stem.rfind('.'));
+	for (const StubToxShape& shape : StubToxShapes) {
+		if (stem == shape.Stem) {
+			return &shape;
+		}
+	}
+	return nullptr;
+}
+
+static double GetEnvironmentNumber(const char* name, double fallback) {
+	const char* value = getenv(name);
+	return value != nullptr ? std::max(atof(value), 0.0) : fallback;
+}
+
+// Lays out the links of the tox at 'path' and sets how it renders, see the top of the file
+static void BuildLinks(TEInstance_* instance, const std::string& path) {
+	const StubToxShape* shape = FindShape(path);
+	int32_t nextFloat = shape != nullptr ? BuildShapeLinks(instance, *shape) : BuildDefaultLinks(instance);
+
+	AddFloatParameters(instance, nextFloat, static_cast<int32_t>(GetEnvironmentNumber("TE_STUB_PARAMETERS", 0.0)));
+	instance->CookMs = GetEnvironmentNumber("TE_STUB_COOK_MS", shape != nullptr ? shape->CookMs : 0.0);
+}
+
+static bool FileExists(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr) {
+		return false;
+	}
+	fclose(file);
+	return true;
+}
+
+extern "C" {
+
+TEObject* TERetain(TEObject* object) {
+	StubObject* stub = FindObject(object);
+	if (stub != nullptr) {
+		stub->RefCount++;
+	}
+	return object;
+}
+
+void TERelease_(TEObject** object) {
+	if (object == nullptr || *object == nullptr) {
+		return;
+	}
+	StubObject* stub = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(ObjectsMutex);
+		auto it = Objects.find(*object);
+		if (it != Objects.end() && --it->second->RefCount == 0) {
+			stub = it->second;
+			Objects.erase(it);
+		}
+	}
+	*object = nullptr;
+	delete stub;
+}
+
+TEObjectType TEGetType(const TEObject* object) {
+	StubObject* stub = FindObject(object);
+	return stub != nullptr ? stub->Type : TEObjectTypeUnknown;
+}
+
+const char* TEResultGetDescription(TEResult result) {
+	return result == TEResultSuccess ? "Success" : "Stub TouchEngine error";
+}
+
+TESeverity TEResultGetSeverity(TEResult result) {
+	return result == TEResultSuccess ? TESeverityNone : TESeverityError;
+}
+
+TEResult TEInstanceGetSupportedFileExtensions(TEStringArray** extensions) {
+	*extensions = CreateStringArray({ "tox" });
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceCreate(TEInstanceEventCallback event_callback, TEInstanceLinkCallback link_callback, void* callback_info, TEInstance** instance) {
+	TEInstance_* created = new TEInstance_();
+	created->EventCallback = event_callback;
+	created->LinkCallback = link_callback;
+	created->Info = callback_info;
+	created->Worker = std::thread(&TEInstance_::Run, created);
+	*instance = Track(created, created, TEObjectTypeInstance);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceConfigure(TEInstance* instance, const char* path, TETimeMode mode) {
+	{
+		std::lock_guard<std::mutex> lock(instance->Mutex);
+		if (instance->Loaded) {
+			instance->ClearLinks();
+			instance->Loaded = false;
+		}
+		instance->Path = path != nullptr ? path : "";
+		instance->TimeMode = mode;
+	}
+	instance->Post([instance] { instance->SendEvent(TEEventInstanceReady, TEResultSuccess); });
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLoad(TEInstance* instance) {
+	std::string path;
+	{
+		std::lock_guard<std::mutex> lock(instance->Mutex);
+		path = instance->Path;
+	}
+	if (path.empty()) {
+		return TEResultBadUsage;
+	}
+
+	instance->Post([instance, path] {
+		if (!FileExists(path)) {
+			instance->SendEvent(TEEventInstanceDidLoad, TEResultFileError);
+			return;
+		}
+
+		std::vector<std::string> identifiers;
+		{
+			std::lock_guard<std::mutex> lock(instance->Mutex);
+			instance->ClearLinks();
+			BuildLinks(instance, path);
+			instance->Loaded = true;
+			instance->Suspended = true;
+			for (const auto& link : instance->Links) {
+				identifiers.push_back(link.first);
+			}
+		}
+		for (const std::string& identifier : identifiers) {
+			instance->SendLinkEvent(TELinkEventAdded, identifier);
+		}
+		instance->SendEvent(TEEventInstanceDidLoad, TEResultSuccess);
+	});
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceUnload(TEInstance* instance) {
+	{
+		std::lock_guard<std::mutex> lock(instance->Mutex);
+		instance->ClearLinks();
+		instance->Loaded = false;
+		instance->FrameBusy = false;
+	}
+	instance->Post([instance] { instance->SendEvent(TEEventInstanceDidUnload, TEResultSuccess); });
+	return TEResultSuccess;
+}
+
+bool TEInstanceHasFile(TEInstance* instance) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	return !instance->Path.empty();
+}
+
+void TEInstanceGetPath(TEInstance* instance, TEString** string) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	*string = CreateString(instance->Path);
+}
+
+TETimeMode TEInstanceGetTimeMode(TEInstance* instance) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	return instance->TimeMode;
+}
+
+TEResult TEInstanceAssociateGraphicsContext(TEInstance* instance, TEGraphicsContext* context) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	if (instance->Context != nullptr) {
+		TERelease(&instance->Context);
+	}
+	instance->Context = context != nullptr ? TERetain(context) : nullptr;
+	// Like TouchEngine, a new context puts outputs back in its native orientation
+	instance->OutputOrigin = TETextureOriginBottomLeft;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceAssociateAdapter(TEInstance* instance, TEAdapter* adapter) {
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceSetOutputTextureOrigin(TEInstance* instance, TETextureOrigin origin) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	instance->OutputOrigin = origin;
+	return TEResultSuccess;
+}
+
+TETextureOrigin TEInstanceGetOutputTextureOrigin(TEInstance* instance) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	return instance->OutputOrigin;
+}
+
+TEResult TEInstanceResume(TEInstance* instance) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	instance->Suspended = false;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceSuspend(TEInstance* instance) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	instance->Suspended = true;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceSetFrameRate(TEInstance* instance, int64_t numerator, int32_t denominator) {
+	if (numerator <= 0 || denominator <= 0) {
+		return TEResultBadUsage;
+	}
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	instance->RateNumerator = numerator;
+	instance->RateDenominator = denominator;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceSetFloatFrameRate(TEInstance* instance, float rate) {
+	return TEInstanceSetFrameRate(instance, static_cast<int64_t>(rate * 1000.0f + 0.5f), 1000);
+}
+
+TEResult TEInstanceGetFrameRate(TEInstance* instance, int64_t* numerator, int32_t* denominator) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	*numerator = instance->RateNumerator;
+	*denominator = instance->RateDenominator;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceGetFloatFrameRate(TEInstance* instance, float* rate) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	*rate = static_cast<float>(instance->RateNumerator) / instance->RateDenominator;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceSetStatisticsCallback(TEInstance* instance, TEInstanceStatisticsCallback callback) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	instance->StatisticsCallback = callback;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceAddTextureTransfer(TEInstance* instance, TETexture* texture, TESemaphore* semaphore, uint64_t value) {
+	return TEResultSuccess;
+}
+
+bool TEInstanceHasTextureTransfer(TEInstance* instance, const TETexture* texture) {
+	return false;
+}
+
+TEResult TEInstanceGetTextureTransfer(TEInstance* instance, const TETexture* texture, TESemaphore** semaphore, uint64_t* waitValue) {
+	*semaphore = nullptr;
+	*waitValue = 0;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceStartFrameAtTime(TEInstance* instance, int64_t time_value, int32_t time_scale, bool discontinuity) {
+	{
+		std::lock_guard<std::mutex> lock(instance->Mutex);
+		if (!instance->Loaded || instance->Suspended) {
+			return TEResultBadUsage;
+		}
+		if (instance->FrameBusy) {
+			return TEResultBadUsage;
+		}
+		instance->FrameBusy = true;
+	}
+
+	instance->Post([instance, time_value, time_scale] {
+		auto start = std::chrono::steady_clock::now();
+		double cookMs = 0.0;
+		{
+			std::lock_guard<std::mutex> lock(instance->Mutex);
+			cookMs = instance->CookMs;
+		}
+		if (cookMs > 0.0) {
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(cookMs));
+		}
+
+		std::vector<std::string> changed;
+		TEInstanceStatisticsCallback statisticsCallback = nullptr;
+		bool cancelled = false;
+		{
+			std::lock_guard<std::mutex> lock(instance->Mutex);
+			cancelled = !instance->FrameBusy || !instance->Loaded;
+			instance->FrameBusy = false;
+			if (!cancelled) {
+				instance->FramesCooked++;
+				// The CHOP output follows the frame time so readers see values change
+				StubLink* chop = instance->FindLink("op/chop1");
+				if (chop != nullptr && chop->Buffer != nullptr) {
+					float seconds = time_scale > 0 ? static_cast<float>(time_value) / time_scale : 0.0f;
+					float first = std::sin(seconds);
+					float second = std::cos(seconds);
+					const float* values[] = { &first, &second };
+					TEFloatBufferSetValues(chop->Buffer, values, 1);
+					changed.push_back(chop->Identifier);
+				}
+				changed.push_back("op/out1");
+				statisticsCallback = instance->StatisticsCallback;
+			}
+		}
+		if (cancelled) {
+			instance->SendEvent(TEEventFrameDidFinish, TEResultCancelled, time_value, time_scale);
+			return;
+		}
+
+		for (const std::string& identifier : changed) {
+			instance->SendLinkEvent(TELinkEventValueChange, identifier);
+		}
+		if (statisticsCallback != nullptr) {
+			TEInstanceStatistics statistics = {};
+			statistics.frameTimeCPU = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			statistics.frameTimeGPU = -1;
+			statistics.frames = 1;
+			statistics.framesDropped = -1;
+			statisticsCallback(instance, &statistics, instance->Info);
+		}
+		instance->SendEvent(TEEventFrameDidFinish, TEResultSuccess, time_value, time_scale);
+	});
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceCancelFrame(TEInstance* instance) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	instance->FrameBusy = false;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceGetErrors(TEInstance* instance, TEErrorArray** errors) {
+	StubErrorArray* object = new StubErrorArray();
+	*errors = Track(object, &object->Value, TEObjectTypeErrorArray);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetChildren(TEInstance* instance, const char* identifier, TEStringArray** children) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr) {
+		return TEResultNoMatchingEntity;
+	}
+	*children = CreateStringArray(link->Children);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceGetLinkGroups(TEInstance* instance, TEScope scope, TEStringArray** groups) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	*groups = CreateStringArray(scope == TEScopeInput ? instance->InputGroups : instance->OutputGroups);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetInfo(TEInstance* instance, const char* identifier, TELinkInfo** info) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr) {
+		return TEResultNoMatchingEntity;
+	}
+
+	StubLinkInfo* object = new StubLinkInfo();
+	object->Label = link->Label;
+	object->Name = link->Name;
+	object->Identifier = link->Identifier;
+	object->Value.scope = link->Scope;
+	object->Value.intent = link->Intent;
+	object->Value.type = link->Type;
+	object->Value.domain = link->Domain;
+	object->Value.count = link->GetCount();
+	object->Value.label = object->Label.c_str();
+	object->Value.name = object->Name.c_str();
+	object->Value.identifier = object->Identifier.c_str();
+	*info = Track(object, &object->Value, TEObjectTypeLinkInfo);
+	return TEResultSuccess;
+}
+
+bool TEInstanceLinkHasChoices(TEInstance* instance, const char* identifier) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	return link != nullptr && !link->Choices.empty();
+}
+
+TEResult TEInstanceLinkGetChoiceLabels(TEInstance* instance, const char* identifier, TEStringArray** labels) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr) {
+		return TEResultNoMatchingEntity;
+	}
+	*labels = CreateStringArray(link->Choices);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetChoiceValues(TEInstance* instance, const char* identifier, TEStringArray** values) {
+	return TEInstanceLinkGetChoiceLabels(instance, identifier, values);
+}
+
+static const std::vector<double>* GetValues(const StubLink& link, TELinkValue which) {
+	switch (which) {
+	case TELinkValueMinimum:
+	case TELinkValueUIMinimum:
+		return &link.Min;
+	case TELinkValueMaximum:
+	case TELinkValueUIMaximum:
+		return &link.Max;
+	case TELinkValueDefault:
+		return &link.Default;
+	default:
+		return &link.Value;
+	}
+}
+
+bool TEInstanceLinkHasValue(TEInstance* instance, const char* identifier, TELinkValue which, int32_t index) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	return link != nullptr && index >= 0 && index < static_cast<int32_t>(GetValues(*link, which)->size());
+}
+
+TEResult TEInstanceLinkGetBooleanValue(TEInstance* instance, const char* identifier, TELinkValue which, bool* value) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeBoolean) {
+		return TEResultNoMatchingEntity;
+	}
+	*value = (*GetValues(*link, which))[0] != 0.0;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetDoubleValue(TEInstance* instance, const char* identifier, TELinkValue which, double* value, int32_t count) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeDouble) {
+		return TEResultNoMatchingEntity;
+	}
+	const std::vector<double>& values = *GetValues(*link, which);
+	if (count > static_cast<int32_t>(values.size())) {
+		return TEResultBadUsage;
+	}
+	std::copy(values.begin(), values.begin() + count, value);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetIntValue(TEInstance* instance, const char* identifier, TELinkValue which, int32_t* value, int32_t count) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeInt) {
+		return TEResultNoMatchingEntity;
+	}
+	const std::vector<double>& values = *GetValues(*link, which);
+	if (count > static_cast<int32_t>(values.size())) {
+		return TEResultBadUsage;
+	}
+	for (int32_t i = 0; i < count; i++) {
+		value[i] = static_cast<int32_t>(values[i]);
+	}
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetStringValue(TEInstance* instance, const char* identifier, TELinkValue which, TEString** string) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || (link->Type != TELinkTypeString && link->Type != TELinkTypeStringData)) {
+		return TEResultNoMatchingEntity;
+	}
+	*string = CreateString(link->Text);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetTextureValue(TEInstance* instance, const char* identifier, TELinkValue which, TETexture** value) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeTexture) {
+		return TEResultNoMatchingEntity;
+	}
+	// Inputs aren't handed back, outputs only have content once a frame has cooked
+	*value = nullptr;
+	if (link->Scope != TEScopeOutput || instance->FramesCooked == 0) {
+		return TEResultSuccess;
+	}
+
+	int32_t width = instance->OutputWidth > 0 ? instance->OutputWidth : instance->InputWidth > 0 ? instance->InputWidth : 1920;
+	int32_t height = instance->OutputHeight > 0 ? instance->OutputHeight : instance->InputHeight > 0 ? instance->InputHeight : 1080;
+	StubOutputTexture& texture = instance->OutputTextures[link->Identifier];
+	if (texture.Name == 0 || texture.Format != instance->OutputFormat || texture.Width != width || texture.Height != height) {
+		if (texture.Name == 0) {
+			glGenTextures(1, &texture.Name);
+		}
+		texture.Format = instance->OutputFormat;
+		texture.Width = width;
+		texture.Height = height;
+		texture.Frame = 0;
+		glBindTexture(GL_TEXTURE_2D, texture.Name);
+		glTexImage2D(GL_TEXTURE_2D, 0, texture.Format, width, height, 0, GL_RGBA, texture.Format == GL_RGBA32F ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	if (texture.Frame != instance->FramesCooked) {
+		// Stands in for the render, every pixel of the output is written once per frame
+		float shade = static_cast<float>(instance->FramesCooked % 64) / 63.0f;
+		const float color[4] = { shade, 1.0f - shade, 0.5f, 1.0f };
+		glClearTexImage(texture.Name, 0, GL_RGBA, GL_FLOAT, color);
+		texture.Frame = instance->FramesCooked;
+	}
+
+	*value = TEOpenGLTextureCreate(texture.Name, GL_TEXTURE_2D, texture.Format, width, height, instance->OutputOrigin, kTETextureComponentMapIdentity, nullptr, nullptr);
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetTableValue(TEInstance* instance, const char* identifier, TELinkValue which, TETable** value) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeStringData) {
+		return TEResultNoMatchingEntity;
+	}
+	*value = link->Table != nullptr ? static_cast<TETable*>(TERetain(link->Table)) : nullptr;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkGetFloatBufferValue(TEInstance* instance, const char* identifier, TELinkValue which, TEFloatBuffer** value) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeFloatBuffer) {
+		return TEResultNoMatchingEntity;
+	}
+	// A copy, the output buffer changes on the next frame
+	*value = link->Buffer != nullptr ? TEFloatBufferCreateCopy(link->Buffer) : nullptr;
+	return TEResultSuccess;
+}
+
+static TEResult SetValues(TEInstance* instance, const char* identifier, TELinkType type, const double* value, int32_t count) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != type || link->Scope != TEScopeInput) {
+		return TEResultNoMatchingEntity;
+	}
+	if (count > static_cast<int32_t>(link->Value.size())) {
+		return TEResultBadUsage;
+	}
+	std::copy(value, value + count, link->Value.begin());
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkSetBooleanValue(TEInstance* instance, const char* identifier, bool value) {
+	double converted = value ? 1.0 : 0.0;
+	return SetValues(instance, identifier, TELinkTypeBoolean, &converted, 1);
+}
+
+TEResult TEInstanceLinkSetDoubleValue(TEInstance* instance, const char* identifier, const double* value, int32_t count) {
+	return SetValues(instance, identifier, TELinkTypeDouble, value, count);
+}
+
+TEResult TEInstanceLinkSetIntValue(TEInstance* instance, const char* identifier, const int32_t* value, int32_t count) {
+	std::vector<double> converted(value, value + std::max(count, 0));
+	return SetValues(instance, identifier, TELinkTypeInt, converted.data(), count);
+}
+
+TEResult TEInstanceLinkSetStringValue(TEInstance* instance, const char* identifier, const char* value) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || (link->Type != TELinkTypeString && link->Type != TELinkTypeStringData) || link->Scope != TEScopeInput) {
+		return TEResultNoMatchingEntity;
+	}
+	link->Text = value != nullptr ? value : "";
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkSetTextureValue(TEInstance* instance, const char* identifier, TETexture* texture, TEGraphicsContext* context) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeTexture || link->Scope != TEScopeInput) {
+		return TEResultNoMatchingEntity;
+	}
+	// Outputs that follow the input take its size from the next frame
+	if (texture != nullptr && TETextureGetType(texture) == TETextureTypeOpenGL) {
+		const TEOpenGLTexture* openGL = static_cast<const TEOpenGLTexture*>(texture);
+		instance->InputWidth = TEOpenGLTextureGetWidth(openGL);
+		instance->InputHeight = TEOpenGLTextureGetHeight(openGL);
+	}
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkSetFloatBufferValue(TEInstance* instance, const char* identifier, const TEFloatBuffer* buffer) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeFloatBuffer || link->Scope != TEScopeInput) {
+		return TEResultNoMatchingEntity;
+	}
+	if (link->Buffer != nullptr) {
+		TERelease(&link->Buffer);
+	}
+	link->Buffer = buffer != nullptr ? TEFloatBufferCreateCopy(buffer) : nullptr;
+	return TEResultSuccess;
+}
+
+TEResult TEInstanceLinkAddFloatBuffer(TEInstance* instance, const char* identifier, const TEFloatBuffer* buffer) {
+	if (buffer != nullptr && !TEFloatBufferIsTimeDependent(buffer)) {
+		return TEResultBadUsage;
+	}
+	// Samples are not kept beyond the latest buffer, nothing plays them back
+	return TEInstanceLinkSetFloatBufferValue(instance, identifier, buffer);
+}
+
+TEResult TEInstanceLinkSetTableValue(TEInstance* instance, const char* identifier, const TETable* table) {
+	std::lock_guard<std::mutex> lock(instance->Mutex);
+	StubLink* link = instance->FindLink(identifier);
+	if (link == nullptr || link->Type != TELinkTypeStringData || link->Scope != TEScopeInput) {
+		return TEResultNoMatchingEntity;
+	}
+	if (link->Table != nullptr) {
+		TERelease(&link->Table);
+	}
+	link->Table = table != nullptr ? TETableCreateCopy(table) : nullptr;
+	return TEResultSuccess;
+}
+
+TETextureType TETextureGetType(const TETexture* texture) {
+	return TETextureTypeOpenGL;
+}
+
+TETextureOrigin TETextureGetOrigin(const TETexture* texture) {
+	return static_cast<const TEOpenGLTexture_*>(texture)->Origin;
+}
+
+TEOpenGLTexture* TEOpenGLTextureCreate(GLuint texture, GLenum target, GLint internalFormat, int32_t width, int32_t height, TETextureOrigin origin, TETextureComponentMap map, TEOpenGLTextureCallback callback, void* info) {
+	TEOpenGLTexture_* created = new TEOpenGLTexture_();
+	created->Name = texture;
+	created->Target = target;
+	created->InternalFormat = internalFormat;
+	created->Width = width;
+	created->Height = height;
+	created->Origin = origin;
+	created->Callback = callback;
+	created->Info = info;
+	return Track(created, created, TEObjectTypeTexture);
+}
+
+GLuint TEOpenGLTextureGetName(const TEOpenGLTexture* texture) {
+	return texture->Name;
+}
+
+GLenum TEOpenGLTextureGetTarget(const TEOpenGLTexture* texture) {
+	return texture->Target;
+}
+
+GLint TEOpenGLTextureGetInternalFormat(const TEOpenGLTexture* texture) {
+	return texture->InternalFormat;
+}
+
+int32_t TEOpenGLTextureGetWidth(const TEOpenGLTexture* texture) {
+	return texture->Width;
+}
+
+int32_t TEOpenGLTextureGetHeight(const TEOpenGLTexture* texture) {
+	return texture->Height;
+}
+
+TETable* TETableCreate(void) {
+	TETable_* table = new TETable_();
+	return Track(table, table, TEObjectTypeTable);
+}
+
+TETable* TETableCreateCopy(const TETable* table) {
+	TETable_* copy = new TETable_();
+	copy->Rows = table->Rows;
+	copy->Columns = table->Columns;
+	copy->Cells = table->Cells;
+	return Track(copy, copy, TEObjectTypeTable);
+}
+
+int32_t TETableGetRowCount(const TETable* table) {
+	return table->Rows;
+}
+
+int32_t TETableGetColumnCount(const TETable* table) {
+	return table->Columns;
+}
+
+const char* TETableGetStringValue(const TETable* table, int32_t row, int32_t column) {
+	if (row < 0 || row >= table->Rows || column < 0 || column >= table->Columns) {
+		return nullptr;
+	}
+	return table->Cells[row * table->Columns + column].c_str();
+}
+
+void TETableResize(TETable* table, int32_t rows, int32_t columns) {
+	rows = std::max(rows, 0);
+	columns = std::max(columns, 0);
+	std::vector<std::string> cells(static_cast<size_t>(rows) * columns);
+	for (int32_t r = 0; r < std::min(rows, table->Rows); r++) {
+		for (int32_t c = 0; c < std::min(columns, table->Columns); c++) {
+			cells[r * columns + c] = std::move(table->Cells[r * table->Columns + c]);
+		}
+	}
+	table->Rows = rows;
+	table->Columns = columns;
+	table->Cells = std::move(cells);
+}
+
+TEResult TETableSetStringValue(TETable* table, int32_t row, int32_t column, const char* value) {
+	if (row < 0 || row >= table->Rows || column < 0 || column >= table->Columns) {
+		return TEResultBadUsage;
+	}
+	table->Cells[row * table->Columns + column] = value != nullptr ? value : "";
+	return TEResultSuccess;
+}
+
+TEFloatBuffer* TEFloatBufferCreate(double rate, int32_t channels, uint32_t capacity, const char* const* names) {
+	return CreateFloatBuffer(rate, channels, capacity, names, false);
+}
+
+TEFloatBuffer* TEFloatBufferCreateTimeDependent(double rate, int32_t channels, uint32_t capacity, const char* const* names) {
+	return CreateFloatBuffer(rate, channels, capacity, names, true);
+}
+
+TEFloatBuffer* TEFloatBufferCreateCopy(const TEFloatBuffer* buffer) {
+	TEFloatBuffer* copy = CreateFloatBuffer(buffer->Rate, static_cast<int32_t>(buffer->Channels.size()), buffer->Capacity,
+		buffer->NamePointers.empty() ? nullptr : buffer->NamePointers.data(), buffer->TimeDependent);
+	for (size_t i = 0; i < buffer->Channels.size(); i++) {
+		copy->Channels[i] = buffer->Channels[i];
+		copy->ChannelPointers[i] = copy->Channels[i].data();
+	}
+	copy->Count = buffer->Count;
+	copy->StartTime = buffer->StartTime;
+	copy->ExtendBefore = buffer->ExtendBefore;
+	copy->ExtendAfter = buffer->ExtendAfter;
+	copy->ExtendConstant = buffer->ExtendConstant;
+	return copy;
+}
+
+TEResult TEFloatBufferSetValues(TEFloatBuffer* buffer, const float** values, uint32_t count) {
+	if (count > buffer->Capacity) {
+		return TEResultBadUsage;
+	}
+	for (size_t i = 0; i < buffer->Channels.size(); i++) {
+		std::copy(values[i], values[i] + count, buffer->Channels[i].begin());
+	}
+	buffer->Count = count;
+	return TEResultSuccess;
+}
+
+TEResult TEFloatBufferSetStartTime(TEFloatBuffer* buffer, int64_t start) {
+	buffer->StartTime = start;
+	return TEResultSuccess;
+}
+
+const float* const* TEFloatBufferGetValues(const TEFloatBuffer* buffer) {
+	return buffer->ChannelPointers.data();
+}
+
+bool TEFloatBufferIsTimeDependent(const TEFloatBuffer* buffer) {
+	return buffer->TimeDependent;
+}
+
+int64_t TEFloatBufferGetStartTime(const TEFloatBuffer* buffer) {
+	return buffer->StartTime;
+}
+
+int64_t TEFloatBufferGetEndTime(const TEFloatBuffer* buffer) {
+	return buffer->StartTime + buffer->Count;
+}
+
+uint32_t TEFloatBufferGetCapacity(const TEFloatBuffer* buffer) {
+	return buffer->Capacity;
+}
+
+double TEFloatBufferGetRate(const TEFloatBuffer* buffer) {
+	return buffer->Rate;
+}
+
+int32_t TEFloatBufferGetChannelCount(const TEFloatBuffer* buffer) {
+	return static_cast<int32_t>(buffer->Channels.size());
+}
+
+uint32_t TEFloatBufferGetValueCount(const TEFloatBuffer* buffer) {
+	return buffer->Count;
+}
+
+const char* const* TEFloatBufferGetChannelNames(const TEFloatBuffer* buffer) {
+	return buffer->NamePointers.empty() ? nullptr : buffer->NamePointers.data();
+}
+
+TEFloatBufferExtend TEFloatBufferGetExtendBefore(const TEFloatBuffer* buffer) {
+	return buffer->ExtendBefore;
+}
+
+TEFloatBufferExtend TEFloatBufferGetExtendAfter(const TEFloatBuffer* buffer) {
+	return buffer->ExtendAfter;
+}
+
+float TEFloatBufferGetExtendConstantValue(const TEFloatBuffer* buffer) {
+	return buffer->ExtendConstant;
+}
+
+void TEFloatBufferSetExtend(TEFloatBuffer* buffer, TEFloatBufferExtend before, TEFloatBufferExtend after, float constant) {
+	buffer->ExtendBefore = before;
+	buffer->ExtendAfter = after;
+	buffer->ExtendConstant = constant;
+}
+
+}